@@ -0,0 +1,106 @@
+// Checks that AllocationGuard (--assert-no-alloc) catches a heap allocation
+// made in the middle of a run whose tape keeps extending to the right within
+// its current storage, unless an observer the guard wraps made it. Built
+// against gpt_whole with -DTM_COUNT_ALLOCATIONS by allocation_guard.sh; exits
+// 1 if the guard misses the allocation or trips on a clean run.
+//
+// usage: allocation_guard
+#include "AllocationCounter.h"
+#include "MachineSimulator.h"
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    // Two tapes: copies every a of the input as an x onto the second tape,
+    // moving both heads right, and halts at the end of the input.
+    TuringMachine RightMover() {
+        TuringMachine tm;
+        tm.states = {"s", "h"};
+        tm.inputAlphabet = {'a'};
+        tm.tapeAlphabet = {'a', 'x', '_'};
+        tm.initialState = "s";
+        tm.blankSymbol = '_';
+        tm.finalStates = {"h"};
+        tm.tapeCount = 2;
+        Transition copy;
+        copy.oldState = "s";
+        copy.oldSymbols = {'a', '_'};
+        copy.newSymbols = {'a', 'x'};
+        copy.directions = {Direction::RIGHT, Direction::RIGHT};
+        copy.newState = "s";
+        Transition halt;
+        halt.oldState = "s";
+        halt.oldSymbols = {'_', '_'};
+        halt.newSymbols = {'_', '_'};
+        halt.directions = {Direction::STAY, Direction::STAY};
+        halt.newState = "h";
+        tm.transitions = {copy, halt};
+        return tm;
+    }
+
+    // Allocates once, at a step where the second tape's storage does not
+    // double (it grows at powers of two).
+    class Allocator : public StepObserver {
+    public:
+        explicit Allocator(long long at) : at(at) {}
+
+        void BeforeStep(long long step, const MachineConfiguration& /*config*/, int /*transitionIndex*/) {
+            if (step == at) {
+                leaked.reset(new std::string(64, 'y'));
+            }
+        }
+
+    private:
+        long long at;
+        std::unique_ptr<std::string> leaked;
+    };
+
+    // Returns the guard's message, or an empty string if the run completed.
+    // The allocating observer runs outside the guard unless wrapped is set.
+    std::string RunGuarded(const TuringMachine& tm, long long allocateAt, bool wrapped) {
+        MachineConfiguration config = MachineSimulator::initializeConfiguration(tm, std::string(4000, 'a'));
+        Allocator allocator(allocateAt);
+        AllocationGuard guard(config, wrapped ? std::vector<StepObserver*>{&allocator} : std::vector<StepObserver*>());
+        std::vector<StepObserver*> observers{&guard};
+        if (!wrapped) {
+            observers.insert(observers.begin(), &allocator);
+        }
+        try {
+            MachineSimulator::Run(tm, config, observers);
+        } catch (const std::runtime_error& error) {
+            return error.what();
+        }
+        return "";
+    }
+}
+
+int main() {
+    if (!AllocationCounter::Available()) {
+        std::fprintf(stderr, "allocation_guard: build with -DTM_COUNT_ALLOCATIONS\n");
+        return 1;
+    }
+    TuringMachine tm = RightMover();
+    int failures = 0;
+    std::string clean = RunGuarded(tm, -1, false);
+    if (!clean.empty()) {
+        std::printf("FAIL clean run: %s\n", clean.c_str());
+        ++failures;
+    }
+    std::string tripped = RunGuarded(tm, 1500, false);
+    if (tripped.find("heap allocation in the simulation loop at step 1500") == std::string::npos) {
+        std::printf("FAIL allocation at step 1500 not caught%s%s\n", tripped.empty() ? "" : ": ", tripped.c_str());
+        ++failures;
+    }
+    std::string excused = RunGuarded(tm, 1500, true);
+    if (!excused.empty()) {
+        std::printf("FAIL allocation by a wrapped observer: %s\n", excused.c_str());
+        ++failures;
+    }
+    if (failures == 0) {
+        std::printf("ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Builds gpt_whole with allocation counting, runs the AllocationGuard checks
+# in allocation_guard.cpp and runs the CLI with --assert-no-alloc next to
+# recording observers, which may allocate. Exits 1 if anything fails.
+#
+# usage: bench/allocation_guard.sh
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+sources=$(ls "$ROOT/gpt_whole"/*.cpp | grep -v '/main\.cpp$')
+if ! ${CXX:-g++} -std=c++17 -O2 -pthread -DTM_COUNT_ALLOCATIONS -I"$ROOT/gpt_whole" \
+        -o "$BUILD/allocation_guard" "$ROOT/bench/allocation_guard.cpp" $sources; then
+    echo "allocation_guard: build failed"
+    exit 1
+fi
+"$BUILD/allocation_guard" || exit 1
+
+${CXX:-g++} -std=c++17 -O2 -pthread -DTM_COUNT_ALLOCATIONS -o "$BUILD/turing" "$ROOT/gpt_whole"/*.cpp || exit 1
+input=$(printf 'a%.0s' $(seq 300))
+for options in "--trace-bin $BUILD/run.bin --keyframe-interval 1000" "--flight-recorder 100" "-v"; do
+    if ! "$BUILD/turing" --assert-no-alloc $options "$ROOT/bench/machines/sweep.tm" "$input" > /dev/null 2> "$BUILD/err"; then
+        echo "FAIL --assert-no-alloc $options: $(head -c 200 "$BUILD/err")"
+        exit 1
+    fi
+done
+echo "ok --assert-no-alloc with recording observers"
@@ -0,0 +1,157 @@
+#!/bin/sh
+# Differential harness across the variants. Builds each variant's CLI and
+# the suite driver, runs every workload in workloads.txt through the CLI and
+# compares stdout, stderr and the exit status byte for byte with the first
+# variant that built. Then tabulates parse time, throughput and peak RSS side
+# by side, as measured by the suite driver. Variants that fail to build are
+# reported and shown as "-". Exits 1 if any output differs.
+#
+# The CLI takes the input as one argument, which Linux limits to 128 KiB, so
+# longer inputs are timed but their output is not compared.
+#
+# usage: bench/compare_variants.sh [-s small|medium|large] [-r repeats] [variant...]
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SIZE=small
+REPEATS=3
+while getopts s:r: option; do
+    case $option in
+        s) SIZE=$OPTARG ;;
+        r) REPEATS=$OPTARG ;;
+        *) echo "usage: $0 [-s small|medium|large] [-r repeats] [variant...]" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+case $SIZE in
+    small) COLUMN=1 ;;
+    medium) COLUMN=2 ;;
+    large) COLUMN=3 ;;
+    *) echo "unknown size $SIZE" >&2; exit 1 ;;
+esac
+VARIANTS=${*:-"ds_func ds_module ds_whole gpt_func gpt_module gpt_whole"}
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+WORKLOADS=$(grep -v '^#' "$ROOT/bench/workloads.txt")
+
+# Same run syntax as bench/reference.h.
+expand() {
+    echo "$1" | awk '{
+        out = ""
+        for (i = 1; i <= NF; ++i) {
+            token = $i
+            if (token == "-") continue
+            star = 0
+            for (k = length(token); k > 0; --k) if (substr(token, k, 1) == "*") { star = k; break }
+            if (star == 0) { out = out token; continue }
+            symbols = substr(token, 1, star - 1)
+            count = substr(token, star + 1) + 0
+            for (j = 0; j < count; ++j) out = out symbols
+        }
+        printf "%s", out
+    }'
+}
+
+field() {
+    sed "s/.*\"$1\": \([0-9.]*\).*/\1/" "$2"
+}
+
+BUILT=""
+for variant in $VARIANTS; do
+    sources=$(ls "$ROOT/$variant"/*.cpp | grep -v '/main\.cpp$')
+    if ! ${CXX:-g++} -std=c++17 -O2 -pthread -o "$BUILD/$variant.cli" "$ROOT/$variant"/*.cpp 2> "$BUILD/$variant.log" ||
+       ! ${CXX:-g++} -std=c++17 -O2 -pthread -I"$ROOT/$variant" -o "$BUILD/$variant.suite" \
+            "$ROOT/bench/suite.cpp" $sources 2>> "$BUILD/$variant.log"; then
+        echo "$variant: build failed: $(grep -m1 'error' "$BUILD/$variant.log")"
+        continue
+    fi
+    BUILT="$BUILT $variant"
+    mkdir -p "$BUILD/$variant"
+    echo "$WORKLOADS" | while IFS=':' read -r name machine spec sizes; do
+        n=$(echo "$sizes" | cut -d' ' -f$COLUMN)
+        spec=$(echo "$spec" | sed "s/N/$n/g")
+        echo "$variant $name n=$n" >&2
+        input=$(expand "$spec")
+        if [ ${#input} -lt 131072 ]; then
+            "$BUILD/$variant.cli" "$ROOT/bench/machines/$machine" "$input" > "$BUILD/$variant/$name.out" 2> "$BUILD/$variant/$name.err"
+            echo $? > "$BUILD/$variant/$name.status"
+        fi
+        "$BUILD/$variant.suite" "$ROOT/bench/machines/$machine" "$spec" "$REPEATS" > "$BUILD/$variant/$name.json"
+    done
+done
+if [ -z "$BUILT" ]; then
+    echo "no variant built"
+    exit 1
+fi
+REFERENCE=$(echo $BUILT | cut -d' ' -f1)
+
+# table <title> <cell command>: one row per workload, one column per variant
+table() {
+    echo
+    echo "== $1 =="
+    printf '%-16s' workload
+    for variant in $VARIANTS; do printf ' %12s' "$variant"; done
+    echo
+    echo "$WORKLOADS" | while IFS=':' read -r name machine spec sizes; do
+        printf '%-16s' "$name"
+        for variant in $VARIANTS; do
+            if [ -d "$BUILD/$variant" ]; then
+                printf ' %12s' "$($2 "$variant" "$name")"
+            else
+                printf ' %12s' -
+            fi
+        done
+        echo
+    done
+}
+
+output_cell() {
+    if [ ! -f "$BUILD/$1/$2.status" ]; then
+        echo "not run"
+    elif [ "$1" = "$REFERENCE" ]; then
+        echo "reference"
+    elif cmp -s "$BUILD/$1/$2.out" "$BUILD/$REFERENCE/$2.out" &&
+         cmp -s "$BUILD/$1/$2.err" "$BUILD/$REFERENCE/$2.err" &&
+         cmp -s "$BUILD/$1/$2.status" "$BUILD/$REFERENCE/$2.status"; then
+        echo "same"
+    else
+        echo "DIFFERS"
+    fi
+}
+
+parse_cell() {
+    field parse_seconds "$BUILD/$1/$2.json" | awk '{ printf "%.1f", $1 * 1e6 }'
+}
+
+throughput_cell() {
+    field steps_per_second "$BUILD/$1/$2.json" | awk '{ printf "%.2f", $1 / 1e6 }'
+}
+
+rss_cell() {
+    field peak_rss_kib "$BUILD/$1/$2.json"
+}
+
+echo "size $SIZE, best of $REPEATS, outputs compared with $REFERENCE"
+table "output: stdout, stderr and exit status" output_cell
+table "parse time (us)" parse_cell
+table "simulation throughput (Msteps/s)" throughput_cell
+table "peak RSS (KiB)" rss_cell
+
+status=0
+echo
+for variant in $BUILT; do
+    [ "$variant" = "$REFERENCE" ] && continue
+    echo "$WORKLOADS" | while IFS=':' read -r name machine spec sizes; do
+        [ -f "$BUILD/$variant/$name.status" ] || continue
+        for stream in out err status; do
+            if ! cmp -s "$BUILD/$variant/$name.$stream" "$BUILD/$REFERENCE/$name.$stream"; then
+                echo "$name: $variant $stream differs from $REFERENCE: $(cmp "$BUILD/$variant/$name.$stream" "$BUILD/$REFERENCE/$name.$stream" 2>&1 | head -1 | sed 's/.*differ: //')"
+            fi
+        done
+    done
+done > "$BUILD/divergence"
+if [ -s "$BUILD/divergence" ]; then
+    cat "$BUILD/divergence"
+    status=1
+else
+    echo "all outputs agree"
+fi
+exit $status
@@ -0,0 +1,52 @@
+#!/bin/sh
+# Runs gpt_whole on inputs it must refuse and checks that each run exits 1
+# with the expected message on stderr rather than dying on a signal.
+#
+# usage: bench/error_exits.sh
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+HALT=$ROOT/bench/machines/halt.tm
+
+if ! ${CXX:-g++} -std=c++17 -O2 -pthread -o "$BUILD/turing" "$ROOT/gpt_whole"/*.cpp; then
+    echo "error_exits: build failed"
+    exit 1
+fi
+
+failures=0
+# expect <message> <arguments...>, with stdout going to $OUT (/dev/null)
+expect() {
+    message=$1
+    shift
+    "$BUILD/turing" "$@" > "${OUT:-/dev/null}" 2> "$BUILD/err"
+    status=$?
+    if [ $status -ne 1 ] || ! grep -qF "$message" "$BUILD/err"; then
+        echo "FAIL turing $*: exit $status, stderr: $(head -c 200 "$BUILD/err")"
+        failures=$((failures + 1))
+    fi
+}
+
+expect "input expands to more than" --input-rle 'a*100000000000000' "$HALT"
+expect "input expands to more than" --input-rle 'ab*99999999999999999' "$HALT"
+expect "input expands to more than" -v --input-rle 'a*100000000000000' "$HALT"
+expect "illegal input" --input-rle 'a*3 c' "$HALT"
+
+SWEEP=$ROOT/bench/machines/sweep.tm
+OUT=/dev/full expect "cannot write result" -v "$SWEEP" aaaa
+OUT=/dev/full expect "cannot write result" -v --trace=delta "$SWEEP" aaaa
+OUT=/dev/full expect "cannot write result" -v --trace-every 2 "$SWEEP" aaaa
+
+long=$(printf 'a%.0s' $(seq 400))
+"$BUILD/turing" --trace-bin "$BUILD/run.bin" --keyframe-interval 1000 "$SWEEP" "$long" > /dev/null
+OUT=/dev/full expect "cannot write result" trace render "$BUILD/run.bin"
+OUT=/dev/full expect "cannot write result" trace render --jobs 3 "$BUILD/run.bin"
+# The input line fits under the file size limit, the rendered steps do not.
+(
+    trap '' XFSZ
+    ulimit -f 8
+    OUT=$BUILD/limited expect "cannot write result" trace render --jobs 3 "$BUILD/run.bin"
+    exit $failures
+) || failures=$((failures + 1))
+
+[ $failures -eq 0 ] && echo ok
+[ $failures -eq 0 ]
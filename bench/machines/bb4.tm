@@ -0,0 +1,18 @@
+; 4-state busy beaver champion: from a blank tape it halts after 107 steps
+; with 13 ones written
+#Q = {A,B,C,D,H}
+#S = {1}
+#G = {1,_}
+#q0 = A
+#B = _
+#F = {H}
+#N = 1
+
+A _ 1 r B
+A 1 1 l B
+B _ 1 l A
+B 1 _ l C
+C _ 1 r H
+C 1 1 l D
+D _ 1 r D
+D 1 _ r A
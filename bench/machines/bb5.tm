@@ -0,0 +1,20 @@
+; 5-state busy beaver champion (Marxen and Buntrock): from a blank tape it
+; halts after 47,176,870 steps with 4098 ones written
+#Q = {A,B,C,D,E,H}
+#S = {1}
+#G = {1,_}
+#q0 = A
+#B = _
+#F = {H}
+#N = 1
+
+A _ 1 r B
+A 1 1 l C
+B _ 1 r C
+B 1 1 r B
+C _ 1 r D
+C 1 _ l E
+D _ 1 l A
+D 1 1 l D
+E _ 1 r H
+E 1 _ l A
@@ -0,0 +1,34 @@
+; binary addition: input a+b, most significant bit first. a is moved to
+; tape 1, then both numbers are added from the lowest bit with the carry
+; kept in the state; the sum replaces b on tape 0.
+#Q = {cpa,tob,c0,c1,done}
+#S = {0,1,+}
+#G = {0,1,+,_}
+#q0 = cpa
+#B = _
+#F = {done}
+#N = 2
+
+cpa 0_ _0 rr cpa
+cpa 1_ _1 rr cpa
+cpa +_ __ r* tob
+tob *_ ** r* tob
+tob __ ** ll c0
+c0 00 0* ll c0
+c0 01 1* ll c0
+c0 10 1* ll c0
+c0 11 0* ll c1
+c0 0_ 0* ll c0
+c0 1_ 1* ll c0
+c0 _0 0* ll c0
+c0 _1 1* ll c0
+c0 __ ** ** done
+c1 00 1* ll c0
+c1 01 0* ll c1
+c1 10 0* ll c1
+c1 11 1* ll c1
+c1 0_ 1* ll c0
+c1 1_ 0* ll c1
+c1 _0 1* ll c0
+c1 _1 0* ll c1
+c1 __ 1* ** done
@@ -0,0 +1,74 @@
+; binary multiplication by shift and add: input a x b, most significant
+; bit first. a is copied to tape 1 lowest bit first; for every bit of b,
+; lowest first, a is added into the accumulator on tape 2 from the
+; current base, then the bit at the base is final and marked o (0) or
+; i (1). The product is tape 2 read right to left.
+#Q = {go,cpa,tox,rw,bit,fin,add0,done,add1,back,back2}
+#S = {0,1,x}
+#G = {0,1,x,o,i,_}
+#q0 = go
+#B = _
+#F = {done}
+#N = 3
+
+go 0__ *** r** go
+go 1__ *** r** go
+go x__ *** l** cpa
+cpa 0__ *0* lr* cpa
+cpa 1__ *1* lr* cpa
+cpa ___ *** rl* tox
+tox **_ *** r** tox
+tox *__ *** r** tox
+tox _*_ *** l** rw
+tox ___ *** l** rw
+rw *** *** *l* rw
+rw **_ *** *l* rw
+rw *_* *** *r* bit
+rw *__ *** *r* bit
+bit 0** *** *** fin
+bit 0*_ *** *** fin
+bit 0_* *** *** fin
+bit 0__ *** *** fin
+bit 1** *** *** add0
+bit 1*_ *** *** add0
+bit 1_* *** *** add0
+bit 1__ *** *** add0
+bit x** *** *** done
+bit x*_ *** *** done
+bit x_* *** *** done
+bit x__ *** *** done
+add0 *00 *** *rr add0
+add0 *0_ **0 *rr add0
+add0 *01 *** *rr add0
+add0 *10 **1 *rr add0
+add0 *1_ **1 *rr add0
+add0 *11 **0 *rr add1
+add0 *_* *** *** back
+add0 *__ *** *** back
+add1 *00 **1 *rr add0
+add1 *0_ **1 *rr add0
+add1 *01 **0 *rr add1
+add1 *10 **0 *rr add1
+add1 *1_ **0 *rr add1
+add1 *11 **1 *rr add1
+add1 *_0 **1 *** back
+add1 *__ **1 *** back
+add1 *_1 **0 **r add1
+back *** *** *ll back2
+back **_ *** *ll back2
+back *_* *** *ll back2
+back *__ *** *ll back2
+back2 **0 *** **l back2
+back2 *_0 *** **l back2
+back2 **1 *** **l back2
+back2 *_1 *** **l back2
+back2 *** *** **r fin
+back2 **_ *** **r fin
+back2 *_* *** **r fin
+back2 *__ *** **r fin
+fin **0 **o l*r rw
+fin *_0 **o l*r rw
+fin **_ **o l*r rw
+fin *__ **o l*r rw
+fin **1 **i l*r rw
+fin *_1 **i l*r rw
@@ -0,0 +1,21 @@
+; two-tape copy and compare: accepts u c v over {a,b} when u = v. u is
+; copied to tape 1, tape 1 is rewound, and both tapes are compared.
+#Q = {cp,rw,cmp,accept,reject}
+#S = {a,b,c}
+#G = {a,b,c,_}
+#q0 = cp
+#B = _
+#F = {accept}
+#N = 2
+
+cp a_ *a rr cp
+cp b_ *b rr cp
+cp c_ ** *l rw
+rw c* ** *l rw
+rw c_ ** rr cmp
+cmp aa ** rr cmp
+cmp bb ** rr cmp
+cmp __ ** ** accept
+cmp ** ** ** reject
+cmp *_ ** ** reject
+cmp _* ** ** reject
@@ -0,0 +1,8 @@
+; halts immediately, leaving the input on tape 0 as the result
+#Q = {start}
+#S = {a,b}
+#G = {a,b,_}
+#q0 = start
+#B = _
+#F = {start}
+#N = 1
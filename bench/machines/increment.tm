@@ -0,0 +1,14 @@
+; binary increment
+#Q = {right,carry,done}
+#S = {0,1}
+#G = {0,1,_}
+#q0 = right
+#B = _
+#F = {done}
+#N = 1
+
+right * * r right
+right _ _ l carry
+carry 1 0 l carry
+carry 0 1 * done
+carry _ 1 * done
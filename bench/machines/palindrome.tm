@@ -0,0 +1,19 @@
+; two-tape palindrome checker
+#Q = {cp,mh,cmp,halt_accept,halt_reject}
+#S = {0,1}
+#G = {0,1,_}
+#q0 = cp
+#B = _
+#F = {halt_accept}
+#N = 2
+
+cp 0_ 00 rr cp
+cp 1_ 11 rr cp
+cp __ __ l* mh
+mh *_ ** l* mh
+mh __ __ rl cmp
+cmp 00 ** rl cmp
+cmp 11 ** rl cmp
+cmp __ __ ** halt_accept
+cmp 01 __ ** halt_reject
+cmp 10 __ ** halt_reject
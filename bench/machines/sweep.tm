@@ -0,0 +1,16 @@
+; marks one a per pass and sweeps to the end of the tape and back, so a
+; run over n symbols takes about n^2 steps on a tape that never grows
+#Q = {s,r,l,h}
+#S = {a}
+#G = {a,x,_}
+#q0 = s
+#B = _
+#F = {h}
+#N = 1
+
+s a x r r
+s _ _ * h
+r a a r r
+r _ _ l l
+l a a l l
+l x x r s
@@ -0,0 +1,14 @@
+; unary addition: 1^a+1^b becomes 1^(a+b)
+#Q = {s,t,e,done}
+#S = {1,+}
+#G = {1,+,_}
+#q0 = s
+#B = _
+#F = {done}
+#N = 1
+
+s 1 1 r s
+s + 1 r t
+t 1 1 r t
+t _ _ l e
+e 1 _ * done
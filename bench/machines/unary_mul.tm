@@ -0,0 +1,21 @@
+; unary multiplication: 1^a x 1^b leaves 1^(a*b) on tape 2. a is copied to
+; tape 1, then for every 1 of b tape 1 is swept once, alternately leftwards
+; and rightwards, appending a 1 to tape 2 for each cell.
+#Q = {cp,ml,mr,done}
+#S = {1,x}
+#G = {1,x,_}
+#q0 = cp
+#B = _
+#F = {done}
+#N = 3
+
+cp 1__ *1* rr* cp
+cp x__ *** rl* ml
+ml 11_ **1 *lr ml
+ml 1__ *** rr* mr
+ml _*_ *** *** done
+ml ___ *** *** done
+mr 11_ **1 *rr mr
+mr 1__ *** rl* ml
+mr _*_ *** *** done
+mr ___ *** *** done
@@ -0,0 +1,80 @@
+; universal machine: runs the one-tape machine encoded on its input
+; input: rules, then "#", then the simulated input over {0,1}. A rule is
+; "|" <state> <read> <state> <write> <move>, states written as x, xx,
+; xxx, ... (x is the initial state), symbols 0, 1 or b for blank and moves
+; l or r. Tape 1 holds the simulated tape and tape 2 the current state;
+; the run halts when no rule matches.
+#Q = {init,load,rw,rw1,step,cmp,halt,apply,skip,skip2,skip3,erase,copy,move,back,back2,back3}
+#S = {x,0,1,b,l,r,|,#}
+#G = {x,0,1,b,l,r,|,#,_}
+#q0 = init
+#B = _
+#F = {halt}
+#N = 3
+
+init #__ *** r** load
+init *__ *** r** init
+load 0__ *0* rr* load
+load 1__ *1* rr* load
+load ___ **x ll* rw
+rw **x *** l** rw
+rw *_x *** l** rw
+rw _*x *** r** rw1
+rw __x *** r** rw1
+rw1 **x *** *l* rw1
+rw1 *_x *** *r* step
+step |*x *** r** cmp
+step |_x *** r** cmp
+step #*x *** *** halt
+step #_x *** *** halt
+cmp x*x *** r*r cmp
+cmp x_x *** r*r cmp
+cmp 00_ *** r** apply
+cmp 11_ *** r** apply
+cmp b__ *** r** apply
+cmp *** *** *** skip
+cmp **_ *** *** skip
+cmp *_* *** *** skip
+cmp *__ *** *** skip
+skip *** *** **l skip2
+skip **_ *** **l skip2
+skip *_* *** **l skip2
+skip *__ *** **l skip2
+skip2 **x *** **l skip2
+skip2 *_x *** **l skip2
+skip2 **_ *** **r skip3
+skip2 *__ *** **r skip3
+skip3 |*x *** *** step
+skip3 |_x *** *** step
+skip3 #*x *** *** halt
+skip3 #_x *** *** halt
+skip3 **x *** r** skip3
+skip3 *_x *** r** skip3
+apply x*_ *** **l erase
+apply x__ *** **l erase
+erase x*x **_ **l erase
+erase x_x **_ **l erase
+erase x*_ *** **r copy
+erase x__ *** **r copy
+copy x*_ **x r*r copy
+copy x__ **x r*r copy
+copy 0*_ *0* r** move
+copy 0__ *0* r** move
+copy 1*_ *1* r** move
+copy 1__ *1* r** move
+copy b*_ *_* r** move
+copy b__ *_* r** move
+move l*_ *** rl* back
+move l__ *** rl* back
+move r*_ *** rr* back
+move r__ *** rr* back
+back **_ *** **l back2
+back *__ *** **l back2
+back2 **x *** **l back2
+back2 *_x *** **l back2
+back2 **_ *** **r back3
+back2 *__ *** **r back3
+back3 **x *** l** back3
+back3 *_x *** l** back3
+back3 _*x *** r** step
+back3 __x *** r** step
@@ -0,0 +1,135 @@
+// Runs MachineSimulator::Simulate under Linux hardware performance counters
+// and reports them per simulated step. Built against one variant's sources
+// by perf_counters.sh; it relies only on TMParser::Parse, Simulate and the
+// TuringMachine fields, which every variant shares.
+//
+// usage: perf_counters <machine.tm> '<symbols>*<count> ...' [repeats]
+#include "MachineSimulator.h"
+#include "TMParser.h"
+#include "reference.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Counter {
+        const char* name;
+        unsigned int type;
+        unsigned long long config;
+        int fd;
+        unsigned long long id;
+        double value;
+    };
+
+    int OpenCounter(Counter& counter, int group) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter.type;
+        attr.config = counter.config;
+        attr.disabled = group < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counter.fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, group, 0));
+        if (counter.fd >= 0) {
+            ioctl(counter.fd, PERF_EVENT_IOC_ID, &counter.id);
+        }
+        return counter.fd;
+    }
+
+    std::string PerStep(double value, long long steps, bool available) {
+        if (!available) return "n/a";
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", steps > 0 ? value / static_cast<double>(steps) : 0.0);
+        return text;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: perf_counters <machine.tm> '<symbols>*<count> ...' [repeats]\n");
+        return 1;
+    }
+    TuringMachine tm = TMParser::Parse(argv[1]);
+    std::string input = bench::ExpandRuns(argv[2]);
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 3;
+    long long steps = bench::CountSteps(tm, input);
+
+    // cycles leads the group; the others are read together with it. Any
+    // counter the kernel or the hardware refuses is reported as n/a.
+    Counter counters[] = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, 0, 0},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1, 0, 0},
+        {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1, 0, 0},
+        {"llc-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1, 0, 0},
+    };
+    const size_t count = sizeof(counters) / sizeof(counters[0]);
+    int leader = OpenCounter(counters[0], -1);
+    std::string unavailable;
+    if (leader < 0) {
+        unavailable = std::string(" (counters unavailable: ") + std::strerror(errno) + ")";
+    } else {
+        for (size_t i = 1; i < count; ++i) {
+            OpenCounter(counters[i], leader);
+        }
+    }
+
+    double bestSeconds = -1;
+    for (int r = 0; r < repeats; ++r) {
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+        auto start = std::chrono::steady_clock::now();
+        MachineConfiguration config = MachineSimulator::Simulate(tm, input);
+        auto end = std::chrono::steady_clock::now();
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+        (void)config;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (bestSeconds >= 0 && seconds >= bestSeconds) {
+            continue;
+        }
+        bestSeconds = seconds;
+        if (leader < 0) {
+            continue;
+        }
+        // Group read: nr, time_enabled, time_running, then {value, id} pairs.
+        unsigned long long data[3 + 2 * count];
+        if (read(leader, data, sizeof(data)) < 0) {
+            continue;
+        }
+        double scale = data[2] > 0 ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 1.0;
+        for (unsigned long long k = 0; k < data[0] && k < count; ++k) {
+            for (size_t i = 0; i < count; ++i) {
+                if (counters[i].fd >= 0 && counters[i].id == data[4 + 2 * k]) {
+                    counters[i].value = static_cast<double>(data[3 + 2 * k]) * scale;
+                }
+            }
+        }
+    }
+
+    bool cycles = counters[0].fd >= 0;
+    bool instructions = counters[1].fd >= 0;
+    char ipc[32] = "n/a";
+    if (cycles && instructions && counters[0].value > 0) {
+        std::snprintf(ipc, sizeof(ipc), "%.2f", counters[1].value / counters[0].value);
+    }
+    std::printf("steps=%lld ns/step=%s cycles/step=%s instructions/step=%s ipc=%s branch-misses/step=%s llc-misses/step=%s%s\n",
+                steps, PerStep(bestSeconds * 1e9, steps, true).c_str(),
+                PerStep(counters[0].value, steps, cycles).c_str(),
+                PerStep(counters[1].value, steps, instructions).c_str(), ipc,
+                PerStep(counters[2].value, steps, counters[2].fd >= 0).c_str(),
+                PerStep(counters[3].value, steps, counters[3].fd >= 0).c_str(), unavailable.c_str());
+    return 0;
+}
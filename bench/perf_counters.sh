@@ -0,0 +1,29 @@
+#!/bin/sh
+# Per-step hardware counters (cycles, instructions, IPC, branch and LLC
+# misses) for every variant ("engine") and workload. Variants that fail to
+# build are reported and skipped; without perf_event access (for example
+# perf_event_paranoid > 2 or inside a container) only time per step is shown.
+#
+# usage: bench/perf_counters.sh [variant...]
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+VARIANTS=${*:-gpt_whole}
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+WORKLOADS="sweep.tm|a*4000
+increment.tm|1*2000000
+palindrome.tm|10*500000 01*500000"
+
+for variant in $VARIANTS; do
+    sources=$(ls "$ROOT/$variant"/*.cpp | grep -v '/main\.cpp$')
+    if ! ${CXX:-g++} -std=c++17 -O2 -pthread -I"$ROOT/$variant" -o "$BUILD/$variant" \
+            "$ROOT/bench/perf_counters.cpp" $sources 2> "$BUILD/$variant.log"; then
+        echo "$variant: build failed (see compiler output below)"
+        head -5 "$BUILD/$variant.log"
+        continue
+    fi
+    echo "$WORKLOADS" | while IFS='|' read -r machine input; do
+        printf '%s %s: ' "$variant" "$machine"
+        "$BUILD/$variant" "$ROOT/bench/machines/$machine" "$input" 3
+    done
+done
@@ -0,0 +1,88 @@
+// Helpers shared by the benchmark drivers. They only use the TuringMachine
+// fields every variant shares, so the drivers build against any variant.
+#pragma once
+#include "types/TuringMachine.h"
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+    // Expands "ab*3 c*2" to "abababcc"; a token without '*' is taken as is
+    // and "-" stands for the empty input.
+    inline std::string ExpandRuns(const std::string& spec) {
+        std::istringstream in(spec);
+        std::string token;
+        std::string input;
+        while (in >> token) {
+            if (token == "-") {
+                continue;
+            }
+            size_t star = token.rfind('*');
+            if (star == std::string::npos) {
+                input += token;
+                continue;
+            }
+            std::string symbols = token.substr(0, star);
+            long long count = std::atoll(token.c_str() + star + 1);
+            for (long long i = 0; i < count; ++i) {
+                input += symbols;
+            }
+        }
+        return input;
+    }
+
+    // Independent step count, so per-step figures do not depend on what the
+    // variant under test exposes. Same semantics as the simulators: first
+    // matching transition, '*' reads any non-blank and writes nothing.
+    // Tapes are dense arrays grown on demand from both ends.
+    inline long long CountSteps(const TuringMachine& tm, const std::string& input) {
+        struct DenseTape {
+            std::vector<char> cells;
+            long long origin = 0;
+        };
+        std::vector<DenseTape> tapes(static_cast<size_t>(tm.tapeCount));
+        for (DenseTape& tape : tapes) {
+            tape.cells.assign(64, tm.blankSymbol);
+        }
+        if (!tapes.empty() && !input.empty()) {
+            tapes[0].cells.assign(input.begin(), input.end());
+        }
+        std::vector<long long> heads(tapes.size(), 0);
+        std::string state = tm.initialState;
+        long long steps = 0;
+        while (true) {
+            for (size_t i = 0; i < tapes.size(); ++i) {
+                DenseTape& tape = tapes[i];
+                long long size = static_cast<long long>(tape.cells.size());
+                if (heads[i] < tape.origin) {
+                    tape.cells.insert(tape.cells.begin(), static_cast<size_t>(size), tm.blankSymbol);
+                    tape.origin -= size;
+                } else if (heads[i] >= tape.origin + size) {
+                    tape.cells.resize(static_cast<size_t>(2 * size), tm.blankSymbol);
+                }
+            }
+            const Transition* fired = nullptr;
+            for (const Transition& t : tm.transitions) {
+                if (t.oldState != state) continue;
+                bool match = true;
+                for (size_t i = 0; i < tapes.size() && match; ++i) {
+                    char symbol = tapes[i].cells[static_cast<size_t>(heads[i] - tapes[i].origin)];
+                    match = t.oldSymbols[i] == '*' ? symbol != tm.blankSymbol : symbol == t.oldSymbols[i];
+                }
+                if (match) {
+                    fired = &t;
+                    break;
+                }
+            }
+            if (!fired) return steps;
+            for (size_t i = 0; i < tapes.size(); ++i) {
+                if (fired->newSymbols[i] != '*') tapes[i].cells[static_cast<size_t>(heads[i] - tapes[i].origin)] = fired->newSymbols[i];
+                if (fired->directions[i] == Direction::LEFT) --heads[i];
+                else if (fired->directions[i] == Direction::RIGHT) ++heads[i];
+            }
+            state = fired->newState;
+            ++steps;
+        }
+    }
+}
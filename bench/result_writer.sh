@@ -0,0 +1,23 @@
+#!/bin/sh
+# Times PrintFinalResult on large result tapes. The machine halts at once, so
+# the run is dominated by building the tape and writing it out.
+#
+# usage: bench/result_writer.sh [variant] [cells...]
+set -e
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+VARIANT=${1:-gpt_whole}
+[ $# -gt 0 ] && shift
+SIZES=${*:-"1000000 10000000 100000000"}
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+${CXX:-g++} -std=c++17 -O2 -pthread -o "$BUILD/turing" "$ROOT/$VARIANT"/*.cpp
+
+for n in $SIZES; do
+    half=$((n / 2))
+    start=$(date +%s%N)
+    "$BUILD/turing" --input-rle "a*$half b*$((n - half))" "$ROOT/bench/machines/halt.tm" > "$BUILD/out"
+    end=$(date +%s%N)
+    bytes=$(wc -c < "$BUILD/out")
+    echo "cells=$n bytes=$bytes ms=$(((end - start) / 1000000))"
+done
@@ -0,0 +1,54 @@
+// Times TMParser::Parse and MachineSimulator::Simulate on one workload and
+// prints the result as a single JSON object. Built against one variant's sources by suite.sh;
+// like perf_counters it relies only on TMParser::Parse, Simulate and the
+// TuringMachine fields. Peak memory is read before the reference step count
+// runs, so it covers parsing, the input and the simulation only.
+//
+// usage: suite <machine.tm> '<symbols>*<count> ...' [repeats]
+#include "MachineSimulator.h"
+#include "TMParser.h"
+#include "reference.h"
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: suite <machine.tm> '<symbols>*<count> ...' [repeats]\n");
+        return 1;
+    }
+    int repeats = argc > 3 ? std::atoi(argv[3]) : 3;
+    TuringMachine tm;
+    double parseSeconds = -1;
+    for (int r = 0; r < repeats || parseSeconds < 0; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        tm = TMParser::Parse(argv[1]);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (parseSeconds < 0 || seconds < parseSeconds) {
+            parseSeconds = seconds;
+        }
+    }
+    std::string input = bench::ExpandRuns(argv[2]);
+
+    double bestSeconds = -1;
+    for (int r = 0; r < repeats || bestSeconds < 0; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        MachineConfiguration config = MachineSimulator::Simulate(tm, input);
+        auto end = std::chrono::steady_clock::now();
+        (void)config;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (bestSeconds < 0 || seconds < bestSeconds) {
+            bestSeconds = seconds;
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    long long steps = bench::CountSteps(tm, input);
+    std::printf("{\"steps\": %lld, \"seconds\": %.6f, \"ns_per_step\": %.3f, \"steps_per_second\": %.0f, \"peak_rss_kib\": %ld, \"parse_seconds\": %.6f}\n",
+                steps, bestSeconds, steps > 0 ? bestSeconds * 1e9 / static_cast<double>(steps) : 0.0,
+                bestSeconds > 0 ? static_cast<double>(steps) / bestSeconds : 0.0, usage.ru_maxrss, parseSeconds);
+    return 0;
+}
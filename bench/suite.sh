@@ -0,0 +1,56 @@
+#!/bin/sh
+# Canonical benchmark suite: every workload in the corpus (workloads.txt) at
+# one input size on every variant ("engine"), reported as JSON on stdout with
+# steps/s, ns/step, peak RSS, parse time and the best of <repeats> times per
+# workload, plus the total time per engine. Variants that fail to build are listed with their
+# status and no results. Progress goes to stderr.
+#
+# usage: bench/suite.sh [-s small|medium|large] [-r repeats] [variant...]
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SIZE=medium
+REPEATS=3
+while getopts s:r: option; do
+    case $option in
+        s) SIZE=$OPTARG ;;
+        r) REPEATS=$OPTARG ;;
+        *) echo "usage: $0 [-s small|medium|large] [-r repeats] [variant...]" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+case $SIZE in
+    small) COLUMN=1 ;;
+    medium) COLUMN=2 ;;
+    large) COLUMN=3 ;;
+    *) echo "unknown size $SIZE" >&2; exit 1 ;;
+esac
+VARIANTS=${*:-"ds_func ds_module ds_whole gpt_func gpt_module gpt_whole"}
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+printf '{\n  "suite": "turing-bench",\n  "format": 1,\n  "size": "%s",\n  "repeats": %s,\n  "engines": [' "$SIZE" "$REPEATS"
+separator=""
+for variant in $VARIANTS; do
+    printf '%s\n    {"engine": "%s", ' "$separator" "$variant"
+    separator=","
+    sources=$(ls "$ROOT/$variant"/*.cpp | grep -v '/main\.cpp$')
+    if ! ${CXX:-g++} -std=c++17 -O2 -pthread -I"$ROOT/$variant" -o "$BUILD/$variant" \
+            "$ROOT/bench/suite.cpp" $sources 2> "$BUILD/$variant.log"; then
+        echo "$variant: build failed" >&2
+        printf '"status": "build failed", "total_seconds": null, "results": []}'
+        continue
+    fi
+    grep -v '^#' "$ROOT/bench/workloads.txt" | while IFS=':' read -r name machine input sizes; do
+        n=$(echo "$sizes" | cut -d' ' -f$COLUMN)
+        echo "$variant $name n=$n" >&2
+        result=$("$BUILD/$variant" "$ROOT/bench/machines/$machine" "$(echo "$input" | sed "s/N/$n/g")" "$REPEATS")
+        printf '%s|%s|%s|%s\n' "$name" "$machine" "$n" "$result"
+    done > "$BUILD/$variant.results"
+    total=$(sed 's/.*"seconds": \([0-9.]*\).*/\1/' "$BUILD/$variant.results" | awk '{ t += $1 } END { printf "%.6f", t }')
+    printf '"status": "ok", "total_seconds": %s, "results": [' "$total"
+    awk -F'|' 'BEGIN { first = 1 }
+        { sub(/^\{/, "", $4)
+          printf "%s\n      {\"workload\": \"%s\", \"machine\": \"%s\", \"n\": %s, %s", first ? "" : ",", $1, $2, $3, $4
+          first = 0 }
+        END { printf "\n    ]}" }' "$BUILD/$variant.results"
+done
+printf '\n  ]\n}\n'
@@ -0,0 +1,141 @@
+#include "AllocationCounter.h"
+#include "InputStreamer.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#ifdef TM_COUNT_ALLOCATIONS
+
+namespace {
+    std::atomic<unsigned long long> allocations{0};
+    std::atomic<unsigned long long> bytes{0};
+    thread_local unsigned long long threadAllocations = 0;
+
+    void Count(std::size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        ++threadAllocations;
+    }
+}
+
+// The other forms of new and delete in libstdc++ forward to these.
+void* operator new(std::size_t size) {
+    Count(size);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    Count(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    void* p = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+bool AllocationCounter::Available() {
+    return true;
+}
+
+unsigned long long AllocationCounter::Allocations() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long AllocationCounter::Bytes() {
+    return bytes.load(std::memory_order_relaxed);
+}
+
+unsigned long long AllocationCounter::ThreadAllocations() {
+    return threadAllocations;
+}
+
+#else
+
+bool AllocationCounter::Available() {
+    return false;
+}
+
+unsigned long long AllocationCounter::Allocations() {
+    return 0;
+}
+
+unsigned long long AllocationCounter::Bytes() {
+    return 0;
+}
+
+unsigned long long AllocationCounter::ThreadAllocations() {
+    return 0;
+}
+
+#endif
+
+AllocationGuard::AllocationGuard(const MachineConfiguration& config, const std::vector<StepObserver*>& observers)
+    : observers(observers), extents(config.tapes.size()) {
+}
+
+void AllocationGuard::BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) {
+    check(step, config);
+    for (StepObserver* observer : observers) {
+        observer->BeforeStep(step, config, transitionIndex);
+    }
+    allocations = AllocationCounter::ThreadAllocations();
+}
+
+void AllocationGuard::OnHalt(long long steps, MachineConfiguration& config) {
+    check(steps, config);
+    for (StepObserver* observer : observers) {
+        observer->OnHalt(steps, config);
+    }
+}
+
+void AllocationGuard::OnFinish(long long steps, const MachineConfiguration& config) {
+    for (StepObserver* observer : observers) {
+        observer->OnFinish(steps, config);
+    }
+}
+
+// The allocations seen here were made since the observers of the previous
+// step returned: by its transition and by loading the cells for this one.
+void AllocationGuard::check(long long step, const MachineConfiguration& config) {
+    unsigned long long now = AllocationCounter::ThreadAllocations();
+    bool grew = false;
+    for (size_t i = 0; i < extents.size(); ++i) {
+        const Tape& tape = config.tapes[i];
+        Extent& extent = extents[i];
+        Extent current{tape.cells.capacity(), tape.source ? tape.source->LoadedEnd() : 0,
+                       tape.source && tape.source->Exhausted()};
+        if (current.capacity != extent.capacity || current.loadedEnd != extent.loadedEnd
+            || current.exhausted != extent.exhausted) {
+            grew = true;
+        }
+        extent = current;
+    }
+    if (started && now != allocations && !grew) {
+        throw std::runtime_error("heap allocation in the simulation loop at step " + std::to_string(step) + " ("
+                                 + std::to_string(now - allocations) + " allocations, no tape growth)");
+    }
+    started = true;
+}
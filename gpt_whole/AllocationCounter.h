@@ -0,0 +1,39 @@
+#pragma once
+#include "StepObserver.h"
+#include <vector>
+
+// Counts heap allocations in builds with -DTM_COUNT_ALLOCATIONS; elsewhere
+// Available() is false and the counts stay 0.
+class AllocationCounter {
+public:
+    static bool Available();
+    static unsigned long long Allocations();
+    static unsigned long long Bytes();
+    static unsigned long long ThreadAllocations();
+};
+
+// --assert-no-alloc: fails the run if a step allocates on the simulating
+// thread while no tape's storage or streamed input grew. Wraps the run's
+// other observers, whose own allocations are not counted.
+class AllocationGuard : public StepObserver {
+public:
+    AllocationGuard(const MachineConfiguration& config, const std::vector<StepObserver*>& observers);
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex);
+    void OnHalt(long long steps, MachineConfiguration& config);
+    void OnFinish(long long steps, const MachineConfiguration& config);
+
+private:
+    struct Extent {
+        size_t capacity;
+        long long loadedEnd;
+        bool exhausted;
+    };
+
+    void check(long long step, const MachineConfiguration& config);
+
+    std::vector<StepObserver*> observers;
+    std::vector<Extent> extents;
+    unsigned long long allocations = 0;
+    bool started = false;
+};
@@ -0,0 +1,93 @@
+#include "BinaryTrace.h"
+#include <stdexcept>
+#include <vector>
+
+const char BinaryTrace::kMagic[9] = "TMTRACE1";
+const char BinaryTrace::kIndexMagic[9] = "TMINDEX1";
+
+void BinaryTrace::AppendSigned(OutputBuffer& out, long long value) {
+    unsigned long long zigzag = (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63);
+    BinaryTrace::AppendVarint(out, zigzag);
+}
+
+void BinaryTrace::AppendString(OutputBuffer& out, const std::string& text) {
+    BinaryTrace::AppendVarint(out, text.size());
+    out.Append(text);
+}
+
+void BinaryTrace::AppendTape(OutputBuffer& out, const Tape& tape) {
+    BinaryTrace::AppendSigned(out, tape.headPosition);
+    if (tape.Empty()) {
+        BinaryTrace::AppendSigned(out, 0);
+        BinaryTrace::AppendVarint(out, 0);
+        return;
+    }
+    unsigned long long count = static_cast<unsigned long long>(tape.right - tape.left + 1);
+    BinaryTrace::AppendSigned(out, tape.left);
+    BinaryTrace::AppendVarint(out, count);
+    out.Append(tape.cells.data() + (tape.left - tape.origin), static_cast<size_t>(count));
+}
+
+unsigned long long BinaryTrace::ReadVarint(std::streambuf& in) {
+    unsigned long long value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.sbumpc();
+        if (c == std::streambuf::traits_type::eof()) {
+            throw std::runtime_error("truncated trace");
+        }
+        value |= static_cast<unsigned long long>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("corrupt trace");
+}
+
+long long BinaryTrace::ReadSigned(std::streambuf& in) {
+    unsigned long long zigzag = BinaryTrace::ReadVarint(in);
+    return static_cast<long long>(zigzag >> 1) ^ -static_cast<long long>(zigzag & 1);
+}
+
+char BinaryTrace::ReadByte(std::streambuf& in) {
+    int c = in.sbumpc();
+    if (c == std::streambuf::traits_type::eof()) {
+        throw std::runtime_error("truncated trace");
+    }
+    return static_cast<char>(c);
+}
+
+std::string BinaryTrace::ReadString(std::streambuf& in) {
+    unsigned long long size = BinaryTrace::ReadVarint(in);
+    std::string text(static_cast<size_t>(size), '\0');
+    if (size > 0 && in.sgetn(&text[0], static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+        throw std::runtime_error("truncated trace");
+    }
+    return text;
+}
+
+void BinaryTrace::ReadCells(std::streambuf& in, Tape& tape, long long position, unsigned long long count) {
+    std::vector<char> cells(static_cast<size_t>(count));
+    if (count > 0 && in.sgetn(cells.data(), static_cast<std::streamsize>(count)) != static_cast<std::streamsize>(count)) {
+        throw std::runtime_error("truncated trace");
+    }
+    tape.WriteRange(position, cells.data(), cells.size());
+}
+
+Tape BinaryTrace::ReadTape(std::streambuf& in, char blank) {
+    Tape tape;
+    tape.blank = blank;
+    tape.headPosition = BinaryTrace::ReadSigned(in);
+    long long first = BinaryTrace::ReadSigned(in);
+    unsigned long long count = BinaryTrace::ReadVarint(in);
+    BinaryTrace::ReadCells(in, tape, first, count);
+    return tape;
+}
+
+
+unsigned long long BinaryTrace::ReadFixed(std::streambuf& in) {
+    unsigned long long value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<unsigned long long>(static_cast<unsigned char>(BinaryTrace::ReadByte(in))) << (8 * i);
+    }
+    return value;
+}
\ No newline at end of file
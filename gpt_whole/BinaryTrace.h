@@ -0,0 +1,43 @@
+#pragma once
+#include "OutputBuffer.h"
+#include "types/Tape.h"
+#include <streambuf>
+#include <string>
+
+// --trace-bin format. Integers are LEB128 varints (signed ones zigzagged),
+// strings a varint length and the bytes.
+//   "TMTRACE1", input, blank, tape count, transitions, initial configuration
+//   v > 0              transition v - 1 fired
+//   0 'L' t p n cells  n streamed cells loaded into tape t at p
+//   0 'K' step state tapes...   keyframe
+//   0 'H'              halted; later loads are the drained input
+//   0 'E' steps        end
+//   footer: u64 count, (step, offset) pairs, footer offset, "TMINDEX1"
+class BinaryTrace {
+public:
+    static const char kMagic[9];
+    static const char kIndexMagic[9];
+    static const char kLoad = 'L';
+    static const char kKeyframe = 'K';
+    static const char kHalt = 'H';
+    static const char kEnd = 'E';
+
+    static void AppendVarint(OutputBuffer& out, unsigned long long value) {
+        while (value >= 0x80) {
+            out.Append(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.Append(static_cast<char>(value));
+    }
+    static void AppendSigned(OutputBuffer& out, long long value);
+    static void AppendString(OutputBuffer& out, const std::string& text);
+    static void AppendTape(OutputBuffer& out, const Tape& tape);
+
+    static unsigned long long ReadVarint(std::streambuf& in);
+    static long long ReadSigned(std::streambuf& in);
+    static char ReadByte(std::streambuf& in);
+    static std::string ReadString(std::streambuf& in);
+    static void ReadCells(std::streambuf& in, Tape& tape, long long position, unsigned long long count);
+    static Tape ReadTape(std::streambuf& in, char blank);
+    static unsigned long long ReadFixed(std::streambuf& in);
+};
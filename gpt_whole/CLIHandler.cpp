@@ -5,11 +5,59 @@
 #include "MachineSimulator.h"
 #include "VerboseTracer.h"
 #include "ResultPrinter.h"
+#include "InputStreamer.h"
+#include "RunLengthInput.h"
+#include "TapeDumper.h"
+#include "TraceCommand.h"
+#include "TraceRecorder.h"
+#include "FlightRecorder.h"
+#include "ProgressReporter.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include "SampleProfiler.h"
+#include "TapeProfiler.h"
+#include "PhaseTimer.h"
+#include "TraceEvents.h"
+#include "OutputWriter.h"
+#include "TextFormat.h"
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    inline bool startsWith(const std::string& s, const std::string& prefix) {
+        return s.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    // Prints the --timings report and writes the --trace-events file however
+    // CLIHandler::Main returns.
+    struct RunReports {
+        const RunOptions& options;
+        ~RunReports() {
+            PhaseTimer::Count("output_bytes", OutputWriter::BytesWritten(STDOUT_FILENO));
+            PhaseTimer::Report(options.timingsJson);
+#ifdef TM_TRACE_EVENTS
+            if (!options.traceEventsPath.empty()) {
+                try {
+                    TraceEvents::Export(options.traceEventsPath);
+                } catch (const std::exception& e) {
+                    ErrorHandler::Report(e.what());
+                }
+            }
+#endif
+        }
+    };
+}
 
 int CLIHandler::Main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "trace") {
+        return TraceCommand::Main(argc - 1, argv + 1);
+    }
+
     bool hasHelp = false;
     if (argc == 1) {
         hasHelp = true;
@@ -27,26 +75,161 @@ int CLIHandler::Main(int argc, char* argv[]) {
         return 0;
     }
 
-    bool verboseMode = false;
+    RunOptions options;
+    bool hasInputOption = false;
+    bool runLengthInput = false;
+    std::string inputString;
     std::vector<std::string> filteredArgs;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "-v" || arg == "--verbose") {
-            verboseMode = true;
+            options.verbose = true;
+        } else if (arg == "--input" || arg == "--input-rle") {
+            if (hasInputOption || i + 1 >= argc) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            hasInputOption = true;
+            runLengthInput = (arg == "--input-rle");
+            inputString = argv[++i];
+        } else if (arg == "--dump-tapes") {
+            if (i + 1 >= argc) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            options.dumpDirectory = argv[++i];
+        } else if (arg == "--trace-window") {
+            if (i + 1 >= argc || !TextFormat::ParseCount(argv[i + 1], options.traceWindow)) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--trace=full" || arg == "--trace=delta") {
+            options.verbose = true;
+            options.traceMode = (arg == "--trace=delta") ? TraceMode::DELTA : TraceMode::FULL;
+        } else if (arg == "--trace-when") {
+            if (i + 1 >= argc) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            options.verbose = true;
+            options.traceWhen = argv[++i];
+        } else if (arg == "--trace-every") {
+            if (i + 1 >= argc || !TextFormat::ParseCount(argv[i + 1], options.traceEvery) || options.traceEvery == 0) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            options.verbose = true;
+            ++i;
+        } else if (arg == "--trace-bin") {
+            if (i + 1 >= argc) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            options.traceBinPath = argv[++i];
+        } else if (arg == "--keyframe-interval") {
+            if (i + 1 >= argc || !TextFormat::ParseCount(argv[i + 1], options.keyframeInterval)) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--flight-recorder") {
+            if (i + 1 >= argc || !TextFormat::ParseCount(argv[i + 1], options.flightRecorder)) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--timings" || arg == "--timings=text" || arg == "--timings=json") {
+            options.timings = true;
+            options.timingsJson = (arg == "--timings=json");
+        } else if (arg == "--trace-events") {
+            if (i + 1 >= argc) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            options.traceEventsPath = argv[++i];
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (startsWith(arg, "--profile=")) {
+            options.profile = true;
+            options.profileJsonPath = arg.substr(std::string("--profile=").size());
+        } else if (arg == "--assert-no-alloc") {
+            options.assertNoAlloc = true;
+        } else if (arg == "--tape-profile") {
+            options.tapeProfile = true;
+        } else if (arg == "--sample") {
+            options.sample = true;
+        } else if (startsWith(arg, "--sample=")) {
+            options.sample = true;
+            options.sampleFoldedPath = arg.substr(std::string("--sample=").size());
+        } else if (arg == "--sample-rate") {
+            if (i + 1 >= argc || !TextFormat::ParseCount(argv[i + 1], options.sampleRate) || options.sampleRate == 0 || options.sampleRate > 100000) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--progress") {
+            options.progressIntervalMs = 1000;
+        } else if (startsWith(arg, "--progress=")) {
+            if (!TextFormat::ParseCount(arg.substr(std::string("--progress=").size()), options.progressIntervalMs) || options.progressIntervalMs == 0) {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
+        } else if (startsWith(arg, "--output-format=")) {
+            std::string format = arg.substr(std::string("--output-format=").size());
+            if (format == "text") {
+                options.outputFormat = OutputFormat::TEXT;
+            } else if (format == "rle") {
+                options.outputFormat = OutputFormat::RLE;
+            } else if (format == "binary") {
+                options.outputFormat = OutputFormat::BINARY;
+            } else {
+                ErrorHandler::ReportUsageError();
+                return 1;
+            }
         } else {
             filteredArgs.push_back(arg);
         }
     }
 
-    if (filteredArgs.size() != 2) {
+    if (options.timings) {
+        PhaseTimer::Enable();
+    }
+    if (!options.traceEventsPath.empty()) {
+#ifdef TM_TRACE_EVENTS
+        TraceEvents::Enable();
+#else
+        ErrorHandler::Report("--trace-events needs a build with -DTM_TRACE_EVENTS");
+        return 1;
+#endif
+    }
+    if (options.traceWindow >= 0 && !(options.verbose && options.traceMode == TraceMode::FULL) && options.flightRecorder < 0) {
+        ErrorHandler::Report("--trace-window needs a full verbose trace (-v) or --flight-recorder");
+        return 1;
+    }
+    if (options.verbose && options.outputFormat != OutputFormat::TEXT) {
+        ErrorHandler::Report("--output-format=rle|binary cannot be combined with a verbose trace");
+        return 1;
+    }
+    if (options.assertNoAlloc && !AllocationCounter::Available()) {
+        ErrorHandler::Report("--assert-no-alloc needs a build with -DTM_COUNT_ALLOCATIONS");
+        return 1;
+    }
+    RunReports reports{options};
+
+    if (filteredArgs.size() != (hasInputOption ? 1u : 2u)) {
         ErrorHandler::ReportUsageError();
         return 1;
     }
 
     std::string tmFilePath = filteredArgs[0];
-    std::string inputString = filteredArgs[1];
+    if (!hasInputOption) {
+        inputString = filteredArgs[1];
+    }
+    bool streamInput = hasInputOption && !runLengthInput && inputString == "-";
 
     TuringMachine turingMachine;
+    PhaseTimer::Begin("parse");
     try {
         turingMachine = TMParser::Parse(tmFilePath);
     } catch (const std::exception& e) {
@@ -54,9 +237,50 @@ int CLIHandler::Main(int argc, char* argv[]) {
         return 1;
     }
 
+    struct stat fileInfo;
+    PhaseTimer::Count("bytes_parsed", stat(tmFilePath.c_str(), &fileInfo) == 0 ? static_cast<unsigned long long>(fileInfo.st_size) : 0);
+    PhaseTimer::Count("transitions_loaded", turingMachine.transitions.size());
+
+    if (streamInput && (options.verbose || !options.traceBinPath.empty())) {
+        // A verbose trace prints the whole input and tape at every step, and a
+        // recording must render the same, so stdin is read up front and run
+        // like a literal input.
+        try {
+            inputString = InputStreamer::ReadAll(STDIN_FILENO);
+        } catch (const std::exception& e) {
+            ErrorHandler::Report(e.what());
+            return 1;
+        }
+    } else if (streamInput) {
+        return CLIHandler::runStreaming(turingMachine, options);
+    }
+    if (runLengthInput && options.verbose) {
+        // The trace shows the input in full anyway, so expand it and trace it
+        // like the equivalent literal input.
+        std::vector<InputRun> runs;
+        try {
+            runs = RunLengthInput::Parse(inputString);
+        } catch (const std::length_error& e) {
+            ErrorHandler::Report(e.what());
+            return 1;
+        } catch (const std::exception&) {
+            ErrorHandler::ReportVerboseIllegalInput(inputString, turingMachine.inputAlphabet);
+            return 1;
+        }
+        try {
+            inputString = RunLengthInput::Expand(runs);
+        } catch (const std::exception& e) {
+            ErrorHandler::Report(e.what());
+            return 1;
+        }
+    } else if (runLengthInput) {
+        return CLIHandler::runRunLength(turingMachine, inputString, options);
+    }
+
+    PhaseTimer::Begin("validate");
     bool isValid = InputValidator::Validate(inputString, turingMachine.inputAlphabet);
     if (!isValid) {
-        if (verboseMode) {
+        if (options.verbose) {
             ErrorHandler::ReportVerboseIllegalInput(inputString, turingMachine.inputAlphabet);
         } else {
             ErrorHandler::ReportIllegalInput();
@@ -64,16 +288,143 @@ int CLIHandler::Main(int argc, char* argv[]) {
         return 1;
     }
 
-    if (verboseMode) {
-        VerboseTracer::SimulateAndTrace(turingMachine, inputString);
-    } else {
-        MachineConfiguration finalConfig = MachineSimulator::Simulate(turingMachine, inputString);
-        ResultPrinter::PrintFinalResult(finalConfig);
+    PhaseTimer::Begin("initialize");
+    MachineConfiguration config = MachineSimulator::initializeConfiguration(turingMachine, inputString);
+    return CLIHandler::runConfiguration(turingMachine, inputString, config, options);
+}
+
+// Tape 0 is fed from stdin and validated chunk by chunk while the run goes.
+int CLIHandler::runStreaming(const TuringMachine& turingMachine, const RunOptions& options) {
+    PhaseTimer::Begin("initialize");
+    MachineConfiguration config = MachineSimulator::initializeConfiguration(turingMachine, "");
+    if (!config.tapes.empty()) {
+        config.tapes[0].source = std::make_shared<InputStreamer>(0, turingMachine.inputAlphabet);
     }
+    return CLIHandler::runConfiguration(turingMachine, "-", config, options);
+}
+
+// The runs are validated once each and expanded straight into the tape.
+int CLIHandler::runRunLength(const TuringMachine& turingMachine, const std::string& spec, const RunOptions& options) {
+    std::vector<InputRun> runs;
+    PhaseTimer::Begin("validate");
+    try {
+        runs = RunLengthInput::Parse(spec);
+    } catch (const std::exception& e) {
+        ErrorHandler::Report(e.what());
+        return 1;
+    }
+    if (!InputValidator::Validate(runs, turingMachine.inputAlphabet)) {
+        ErrorHandler::ReportIllegalInput();
+        return 1;
+    }
+    PhaseTimer::Begin("initialize");
+    MachineConfiguration config;
+    try {
+        config = MachineSimulator::initializeConfiguration(turingMachine, runs);
+    } catch (const std::exception& e) {
+        ErrorHandler::Report(e.what());
+        return 1;
+    }
+    return CLIHandler::runConfiguration(turingMachine, spec, config, options);
+}
 
+// A verbose trace runs its writer in front of the same observers.
+int CLIHandler::runConfiguration(const TuringMachine& turingMachine, const std::string& input, MachineConfiguration& config, const RunOptions& options) {
+    try {
+        // Simulation and printing are interleaved in a trace, so they are one phase.
+        PhaseTimer::Begin(options.verbose ? "trace" : "simulate");
+        std::unique_ptr<TraceRecorder> recorder;
+        std::unique_ptr<FlightRecorder> flightRecorder;
+        std::unique_ptr<ProgressReporter> progress;
+        std::unique_ptr<Profiler> profiler;
+        std::unique_ptr<SampleProfiler> sampler;
+        std::unique_ptr<TapeProfiler> tapeProfiler;
+        std::unique_ptr<AllocationGuard> allocationGuard;
+#ifdef TM_TRACE_EVENTS
+        TraceQuanta quanta;
+#endif
+        std::vector<StepObserver*> observers;
+        if (!options.traceBinPath.empty()) {
+            recorder.reset(new TraceRecorder(options.traceBinPath, turingMachine, input, config, options.keyframeInterval));
+            observers.push_back(recorder.get());
+        }
+        if (options.flightRecorder >= 0) {
+            flightRecorder.reset(new FlightRecorder(turingMachine, static_cast<size_t>(options.flightRecorder), config.tapes.size(), options.traceWindow));
+            observers.push_back(flightRecorder.get());
+        }
+        if (options.progressIntervalMs > 0) {
+            progress.reset(new ProgressReporter(turingMachine, config.tapes.size(), options.progressIntervalMs));
+            observers.push_back(progress.get());
+        }
+        if (options.profile) {
+            profiler.reset(new Profiler(turingMachine, options.profileJsonPath));
+            observers.push_back(profiler.get());
+        }
+        if (options.tapeProfile) {
+            tapeProfiler.reset(new TapeProfiler(turingMachine, config.tapes.size()));
+            observers.push_back(tapeProfiler.get());
+        }
+#ifdef TM_TRACE_EVENTS
+        if (TraceEvents::Enabled()) {
+            observers.push_back(&quanta);
+        }
+#endif
+        if (options.assertNoAlloc && !options.verbose) {
+            allocationGuard.reset(new AllocationGuard(config, observers));
+            observers.assign(1, allocationGuard.get());
+        }
+        if (options.sample) {
+            sampler.reset(new SampleProfiler(turingMachine, config, options.sampleFoldedPath, options.sampleRate));
+        }
+        long long steps = 0;
+        if (options.verbose) {
+            steps = VerboseTracer::Trace(turingMachine, input, config, options, observers);
+        } else if (observers.empty()) {
+            steps = MachineSimulator::Run(turingMachine, config);
+        } else {
+            steps = MachineSimulator::Run(turingMachine, config, observers);
+        }
+        if (sampler) {
+            sampler->Finish();
+        }
+        if (!options.verbose) {
+            PhaseTimer::Begin("print");
+            ResultPrinter::PrintFinalResult(config, options.outputFormat);
+        }
+        PhaseTimer::Count("steps_executed", static_cast<unsigned long long>(steps));
+        if (!options.dumpDirectory.empty()) {
+            PhaseTimer::Begin("dump");
+            TapeDumper::Dump(config, options.dumpDirectory);
+        }
+        PhaseTimer::End();
+    } catch (const std::exception& e) {
+        ErrorHandler::Report(e.what());
+        return 1;
+    }
     return 0;
 }
 
 void CLIHandler::PrintHelp() {
-    std::cout << "usage: turing [-v|--verbose] [-h|--help] <tm> <input>" << std::endl;
+    std::cout << "usage: turing [-v|--verbose] [-h|--help] [options] <tm> <input>" << std::endl;
+    std::cout << "       turing [-v|--verbose] [options] --input - <tm>" << std::endl;
+    std::cout << "       turing [-v|--verbose] [options] --input-rle '<symbols>*<count> ...' <tm>" << std::endl;
+    std::cout << "       turing trace expand|render|show|stats ..." << std::endl;
+    std::cout << "options:" << std::endl;
+    std::cout << "  --output-format=text|rle|binary  encoding of the final result" << std::endl;
+    std::cout << "  --dump-tapes <dir>               write every final tape to <dir>/tape<i>.dat" << std::endl;
+    std::cout << "  --trace-window <k>               show only k cells either side of each head (-v, --flight-recorder)" << std::endl;
+    std::cout << "  --trace=full|delta               verbose trace, delta prints only changes" << std::endl;
+    std::cout << "  --trace-when '<expr>'            print only steps matching e.g. 'state == q7 && sym1 == x'" << std::endl;
+    std::cout << "  --trace-every <n>                print only every n-th step" << std::endl;
+    std::cout << "  --keyframe-interval <n>          full configuration every n delta/binary trace steps" << std::endl;
+    std::cout << "  --trace-bin <file>               record a compact binary trace of the run" << std::endl;
+    std::cout << "  --trace-events <file>            Chrome trace-event timeline (builds with -DTM_TRACE_EVENTS)" << std::endl;
+    std::cout << "  --timings[=text|json]            wall/CPU time per phase and run counters to stderr" << std::endl;
+    std::cout << "  --profile[=<json>]               per-state and per-transition counts to stderr (and <json>)" << std::endl;
+    std::cout << "  --assert-no-alloc                fail if a step allocates once the tapes stop growing (builds with -DTM_COUNT_ALLOCATIONS)" << std::endl;
+    std::cout << "  --tape-profile                   head locality, reversals, writes and heatmap per tape to stderr" << std::endl;
+    std::cout << "  --sample[=<folded>]              sample hot states and tape regions to stderr (and <folded> stacks)" << std::endl;
+    std::cout << "  --sample-rate <hz>               samples per CPU second for --sample (default 997)" << std::endl;
+    std::cout << "  --progress[=<ms>]                report progress to stderr every ms (default 1000), or on SIGUSR1" << std::endl;
+    std::cout << "  --flight-recorder <n>            keep the last n steps, print them on halt or SIGUSR2" << std::endl;
 }
\ No newline at end of file
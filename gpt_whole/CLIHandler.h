@@ -1,8 +1,16 @@
 #pragma once
+#include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include "types/RunOptions.h"
 #include <string>
 
 class CLIHandler {
 public:
     static int Main(int argc, char* argv[]);
     static void PrintHelp();
+
+private:
+    static int runStreaming(const TuringMachine& turingMachine, const RunOptions& options);
+    static int runRunLength(const TuringMachine& turingMachine, const std::string& spec, const RunOptions& options);
+    static int runConfiguration(const TuringMachine& turingMachine, const std::string& input, MachineConfiguration& config, const RunOptions& options);
 };
@@ -0,0 +1,214 @@
+#include "DeltaTrace.h"
+#include "OutputBuffer.h"
+#include "ResultPrinter.h"
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+#include <unistd.h>
+
+namespace {
+    OutputBuffer& DeltaOutput() {
+        static OutputBuffer output(STDOUT_FILENO);
+        return output;
+    }
+
+    std::vector<std::string> SplitBySpace(const std::string& line) {
+        std::vector<std::string> tokens;
+        std::istringstream iss(line);
+        std::string token;
+        while (iss >> token) {
+            tokens.push_back(token);
+        }
+        return tokens;
+    }
+
+    long long ToPosition(const std::string& s) {
+        size_t start = (!s.empty() && s[0] == '-') ? 1 : 0;
+        if (start == s.size() || s.size() > 19) {
+            throw std::runtime_error("syntax error");
+        }
+        for (size_t i = start; i < s.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(s[i]))) {
+                throw std::runtime_error("syntax error");
+            }
+        }
+        return std::stoll(s);
+    }
+
+    size_t ToTapeIndex(const std::string& s, const MachineConfiguration& config) {
+        long long index = ToPosition(s);
+        if (index < 0 || index >= static_cast<long long>(config.tapes.size())) {
+            throw std::runtime_error("syntax error");
+        }
+        return static_cast<size_t>(index);
+    }
+}
+
+void DeltaTrace::WriteStart(const std::string& input) {
+    OutputBuffer& out = DeltaOutput();
+    out.Append("Input: ");
+    out.Append(input);
+    out.Append('\n');
+}
+
+void DeltaTrace::WriteKeyframe(long long step, const MachineConfiguration& config) {
+    OutputBuffer& out = DeltaOutput();
+    out.Append("K ");
+    out.AppendInt(step);
+    out.Append(' ');
+    out.Append(config.currentState);
+    out.Append('\n');
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        DeltaTrace::writeTape(i, config.tapes[i]);
+    }
+    out.MaybeFlush();
+}
+
+void DeltaTrace::WriteDelta(long long step, const Transition& t, const std::vector<long long>& previousHeads, const MachineConfiguration& config) {
+    OutputBuffer& out = DeltaOutput();
+    out.Append("D ");
+    out.AppendInt(step);
+    if (t.newState != t.oldState) {
+        out.Append(" s=");
+        out.Append(t.newState);
+    }
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        if (t.newSymbols[i] != '*') {
+            out.Append(" w");
+            out.AppendInt(static_cast<long long>(i));
+            out.Append('=');
+            out.AppendInt(previousHeads[i]);
+            out.Append(':');
+            out.Append(t.newSymbols[i]);
+        }
+    }
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        if (config.tapes[i].headPosition != previousHeads[i]) {
+            out.Append(" h");
+            out.AppendInt(static_cast<long long>(i));
+            out.Append('=');
+            out.AppendInt(config.tapes[i].headPosition);
+        }
+    }
+    out.Append('\n');
+    out.MaybeFlush();
+}
+
+void DeltaTrace::WriteEnd(const MachineConfiguration& config) {
+    OutputBuffer& out = DeltaOutput();
+    out.Append("E\n");
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        DeltaTrace::writeTape(i, config.tapes[i]);
+    }
+    out.Flush();
+}
+
+void DeltaTrace::Flush() {
+    DeltaOutput().Flush();
+}
+
+void DeltaTrace::writeTape(size_t index, const Tape& tape) {
+    OutputBuffer& out = DeltaOutput();
+    out.Append("T ");
+    out.AppendInt(static_cast<long long>(index));
+    out.Append(' ');
+    out.AppendInt(tape.headPosition);
+    if (tape.Empty()) {
+        out.Append(" -\n");
+        return;
+    }
+    out.Append(' ');
+    out.AppendInt(tape.left);
+    out.Append(' ');
+    out.Append(tape.cells.data() + (tape.left - tape.origin), static_cast<size_t>(tape.right - tape.left + 1));
+    out.Append('\n');
+}
+
+void DeltaTrace::readTape(const std::vector<std::string>& tokens, MachineConfiguration& config) {
+    if (tokens.size() < 2 || tokens[0] != "T") {
+        throw std::runtime_error("syntax error");
+    }
+    long long index = ToPosition(tokens[1]);
+    if (index < 0 || index > static_cast<long long>(config.tapes.size())) {
+        throw std::runtime_error("syntax error");
+    }
+    if (index == static_cast<long long>(config.tapes.size())) {
+        config.tapes.push_back(Tape());
+    }
+    Tape& tape = config.tapes[static_cast<size_t>(index)];
+    tape = Tape();
+    if (tokens.size() == 4 && tokens[3] == "-") {
+        tape.headPosition = ToPosition(tokens[2]);
+    } else if (tokens.size() == 5) {
+        tape.headPosition = ToPosition(tokens[2]);
+        tape.WriteRange(ToPosition(tokens[3]), tokens[4].data(), tokens[4].size());
+    } else {
+        throw std::runtime_error("syntax error");
+    }
+}
+
+// Prints a delta trace as -v would have printed the run.
+void DeltaTrace::Expand(std::istream& in, long long window) {
+    std::string line;
+    if (!std::getline(in, line) || line.compare(0, 7, "Input: ") != 0) {
+        throw std::runtime_error("syntax error");
+    }
+    ResultPrinter::PrintVerboseStart(line.substr(7));
+    MachineConfiguration config;
+    bool ended = false;
+    long long pendingStep = -1;
+    while (std::getline(in, line)) {
+        std::vector<std::string> tokens = SplitBySpace(line);
+        if (tokens.empty()) {
+            continue;
+        }
+        if (tokens[0] == "T") {
+            DeltaTrace::readTape(tokens, config);
+            continue;
+        }
+        if (pendingStep >= 0) {
+            ResultPrinter::PrintVerboseStep(pendingStep, config, window);
+            pendingStep = -1;
+        }
+        if (tokens[0] == "K" && tokens.size() == 3) {
+            pendingStep = ToPosition(tokens[1]);
+            config.currentState = tokens[2];
+            config.tapes.clear();
+        } else if (tokens[0] == "D" && tokens.size() >= 2) {
+            long long step = ToPosition(tokens[1]);
+            for (size_t k = 2; k < tokens.size(); ++k) {
+                const std::string& change = tokens[k];
+                size_t eq = change.find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error("syntax error");
+                }
+                std::string value = change.substr(eq + 1);
+                if (change[0] == 's' && eq == 1) {
+                    config.currentState = value;
+                } else if (change[0] == 'w') {
+                    size_t colon = value.find(':');
+                    if (colon == std::string::npos || colon + 2 != value.size()) {
+                        throw std::runtime_error("syntax error");
+                    }
+                    Tape& tape = config.tapes[ToTapeIndex(change.substr(1, eq - 1), config)];
+                    tape.Write(ToPosition(value.substr(0, colon)), value[colon + 1]);
+                } else if (change[0] == 'h') {
+                    config.tapes[ToTapeIndex(change.substr(1, eq - 1), config)].headPosition = ToPosition(value);
+                } else {
+                    throw std::runtime_error("syntax error");
+                }
+            }
+            ResultPrinter::PrintVerboseStep(step, config, window);
+        } else if (tokens[0] == "E" && tokens.size() == 1) {
+            ended = true;
+            config.tapes.clear();
+        } else {
+            throw std::runtime_error("syntax error");
+        }
+    }
+    if (!ended || config.tapes.empty()) {
+        ResultPrinter::FlushVerbose();
+        throw std::runtime_error("syntax error");
+    }
+    ResultPrinter::PrintVerboseResult(config);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "types/MachineConfiguration.h"
+#include "types/Transition.h"
+#include <istream>
+#include <string>
+#include <vector>
+
+// --trace=delta format:
+//   Input: <input>
+//   K <step> <state>, then T <tape> <head> <left> <cells> per tape
+//   D <step> [s=<state>] [w<tape>=<position>:<symbol>]... [h<tape>=<head>]...
+//   E, then T lines of the final tapes
+class DeltaTrace {
+public:
+    static void WriteStart(const std::string& input);
+    static void WriteKeyframe(long long step, const MachineConfiguration& config);
+    static void WriteDelta(long long step, const Transition& t, const std::vector<long long>& previousHeads, const MachineConfiguration& config);
+    static void WriteEnd(const MachineConfiguration& config);
+    static void Flush();
+    static void Expand(std::istream& in, long long window);
+
+private:
+    static void writeTape(size_t index, const Tape& tape);
+    static void readTape(const std::vector<std::string>& tokens, MachineConfiguration& config);
+};
@@ -0,0 +1,89 @@
+#include "FlightRecorder.h"
+#include "MachineSimulator.h"
+#include "ResultPrinter.h"
+#include "OutputBuffer.h"
+#include <csignal>
+#include <unistd.h>
+
+namespace {
+    volatile std::sig_atomic_t dumpRequested = 0;
+    struct sigaction previousAction;
+
+    void requestDump(int) {
+        dumpRequested = 1;
+    }
+}
+
+FlightRecorder::FlightRecorder(const TuringMachine& tm, size_t capacity, size_t tapeCount, long long window)
+    : tm(tm), capacity(capacity), tapeCount(tapeCount), window(window), transitions(capacity), undo(capacity * tapeCount) {
+    struct sigaction action;
+    action.sa_handler = requestDump;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &action, &previousAction);
+}
+
+FlightRecorder::~FlightRecorder() {
+    sigaction(SIGUSR2, &previousAction, nullptr);
+}
+
+// SIGUSR2 only raises a flag; the dump happens here, between steps.
+void FlightRecorder::BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) {
+    if (dumpRequested) {
+        dumpRequested = 0;
+        Dump(step, config);
+    }
+    if (capacity == 0) {
+        return;
+    }
+    size_t slot = static_cast<size_t>(recorded % static_cast<long long>(capacity));
+    transitions[slot] = transitionIndex;
+    UndoCell* cells = &undo[slot * tapeCount];
+    for (size_t i = 0; i < tapeCount; ++i) {
+        const Tape& tape = config.tapes[i];
+        cells[i].symbol = tape.Read(tape.headPosition);
+        cells[i].left = tape.left;
+        cells[i].right = tape.right;
+    }
+    ++recorded;
+}
+
+void FlightRecorder::OnHalt(long long steps, MachineConfiguration& config) {
+    Dump(steps, config);
+}
+
+// Undoes the recorded steps on a copy, newest first, then replays them
+// forward printing each configuration.
+void FlightRecorder::Dump(long long step, const MachineConfiguration& config) const {
+    long long count = std::min(recorded, static_cast<long long>(capacity));
+    MachineConfiguration replay = config;
+    for (long long k = 0; k < count; ++k) {
+        size_t slot = static_cast<size_t>((recorded - 1 - k) % static_cast<long long>(capacity));
+        const Transition& transition = tm.transitions[static_cast<size_t>(transitions[slot])];
+        const UndoCell* cells = &undo[slot * tapeCount];
+        for (size_t i = 0; i < tapeCount; ++i) {
+            Tape& tape = replay.tapes[i];
+            if (transition.directions[i] == Direction::LEFT) {
+                tape.headPosition = tape.headPosition + 1;
+            } else if (transition.directions[i] == Direction::RIGHT) {
+                tape.headPosition = tape.headPosition - 1;
+            }
+            if (transition.newSymbols[i] != '*') {
+                tape.Write(tape.headPosition, cells[i].symbol);
+            }
+            tape.left = cells[i].left;
+            tape.right = cells[i].right;
+        }
+        replay.currentState = transition.oldState;
+    }
+
+    OutputBuffer out(STDERR_FILENO);
+    out.Append("=============== FLIGHT RECORDER ===============\n");
+    for (long long k = count; k > 0; --k) {
+        size_t slot = static_cast<size_t>((recorded - k) % static_cast<long long>(capacity));
+        ResultPrinter::RenderVerboseStep(out, step - k, replay, window);
+        MachineSimulator::applyTransition(replay, tm.transitions[static_cast<size_t>(transitions[slot])], tm.blankSymbol);
+    }
+    ResultPrinter::RenderVerboseStep(out, step, config, window);
+    out.Flush();
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "StepObserver.h"
+#include "types/TuringMachine.h"
+#include <vector>
+
+// --flight-recorder: keeps the last N steps with the cells they overwrote and
+// prints them on halt or SIGUSR2.
+class FlightRecorder : public StepObserver {
+public:
+    FlightRecorder(const TuringMachine& tm, size_t capacity, size_t tapeCount, long long window);
+    ~FlightRecorder();
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex);
+    void OnHalt(long long steps, MachineConfiguration& config);
+
+    // Prints the recorded steps followed by config, which must be the
+    // configuration reached after the newest recorded step.
+    void Dump(long long step, const MachineConfiguration& config) const;
+
+private:
+    // What a step overwrote on one tape: the symbol under the head and the
+    // written bounds before the transition fired.
+    struct UndoCell {
+        char symbol;
+        long long left;
+        long long right;
+    };
+
+    const TuringMachine& tm;
+    size_t capacity;
+    size_t tapeCount;
+    long long window;
+    std::vector<int> transitions;
+    std::vector<UndoCell> undo;
+    long long recorded = 0;
+};
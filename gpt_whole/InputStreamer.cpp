@@ -0,0 +1,86 @@
+#include "InputStreamer.h"
+#include "InputValidator.h"
+#include <stdexcept>
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+    const size_t kChunkSize = 64 * 1024;
+
+    // Length of the line terminator ending data ("\n" or "\r\n"), or 0.
+    size_t TerminatorLength(const std::string& data) {
+        size_t n = data.size();
+        if (n >= 1 && data[n - 1] == '\n') {
+            return (n >= 2 && data[n - 2] == '\r') ? 2 : 1;
+        }
+        return 0;
+    }
+
+    ssize_t ReadSome(int fd, char* buffer, size_t size) {
+        ssize_t n = ::read(fd, buffer, size);
+        while (n < 0 && errno == EINTR) {
+            n = ::read(fd, buffer, size);
+        }
+        if (n < 0) {
+            throw std::runtime_error("cannot read input");
+        }
+        return n;
+    }
+}
+
+InputStreamer::InputStreamer(int fd, const std::set<char>& inputAlphabet)
+    : fd(fd), inputAlphabet(inputAlphabet) {
+}
+
+void InputStreamer::Fill(Tape& tape, long long position) {
+    while (!IsLoaded(position)) {
+        readChunk(tape);
+    }
+}
+
+void InputStreamer::Drain(Tape& tape) {
+    while (!exhausted) {
+        readChunk(tape);
+    }
+}
+
+// A terminator at the end of a chunk is held back until the next read shows
+// whether it ends the stream (dropped) or is followed by more input (illegal).
+bool InputStreamer::readChunk(Tape& tape) {
+    char buffer[kChunkSize];
+    ssize_t n = ReadSome(fd, buffer, sizeof(buffer));
+    if (n == 0) {
+        exhausted = true;
+        if (!pending.empty() && TerminatorLength(pending) != pending.size()) {
+            throw std::runtime_error("illegal input");
+        }
+        pending.clear();
+        return false;
+    }
+    std::string chunk;
+    chunk.swap(pending);
+    chunk.append(buffer, static_cast<size_t>(n));
+    size_t held = TerminatorLength(chunk);
+    if (held == 0 && chunk.back() == '\r') {
+        held = 1;
+    }
+    pending.assign(chunk, chunk.size() - held, held);
+    chunk.resize(chunk.size() - held);
+    if (!InputValidator::Validate(chunk, inputAlphabet)) {
+        throw std::runtime_error("illegal input");
+    }
+    tape.WriteRange(loadedEnd, chunk.data(), chunk.size());
+    loadedEnd += static_cast<long long>(chunk.size());
+    return true;
+}
+
+std::string InputStreamer::ReadAll(int fd) {
+    std::string input;
+    char buffer[kChunkSize];
+    ssize_t n;
+    while ((n = ReadSome(fd, buffer, sizeof(buffer))) > 0) {
+        input.append(buffer, static_cast<size_t>(n));
+    }
+    input.resize(input.size() - TerminatorLength(input));
+    return input;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "types/Tape.h"
+#include <set>
+#include <string>
+
+// Loads tape 0 lazily from a file descriptor (--input -), validating each
+// chunk. Only a final line terminator is dropped.
+class InputStreamer {
+public:
+    InputStreamer(int fd, const std::set<char>& inputAlphabet);
+
+    // Reads the whole stream at once, with the same terminator rule.
+    static std::string ReadAll(int fd);
+
+    bool IsLoaded(long long position) const { return position < loadedEnd || exhausted; }
+    long long LoadedEnd() const { return loadedEnd; }
+    bool Exhausted() const { return exhausted; }
+    void Fill(Tape& tape, long long position);
+    void Drain(Tape& tape);
+
+private:
+    bool readChunk(Tape& tape);
+
+    int fd;
+    std::set<char> inputAlphabet;
+    std::string pending;
+    long long loadedEnd = 0;
+    bool exhausted = false;
+};
@@ -8,4 +8,14 @@ bool InputValidator::Validate(const std::string& inputString, const std::set<cha
         }
     }
     return true;
+}
+
+// Each run is checked once, however many times it repeats.
+bool InputValidator::Validate(const std::vector<InputRun>& runs, const std::set<char>& inputAlphabet) {
+    for (const auto& run : runs) {
+        if (!InputValidator::Validate(run.symbols, inputAlphabet)) {
+            return false;
+        }
+    }
+    return true;
 }
\ No newline at end of file
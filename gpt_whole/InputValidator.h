@@ -1,8 +1,11 @@
 #pragma once
+#include "types/InputRun.h"
 #include <string>
 #include <set>
+#include <vector>
 
 class InputValidator {
 public:
     static bool Validate(const std::string& input, const std::set<char>& inputAlphabet);
+    static bool Validate(const std::vector<InputRun>& runs, const std::set<char>& inputAlphabet);
 };
\ No newline at end of file
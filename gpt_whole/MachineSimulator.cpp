@@ -1,55 +1,137 @@
 #include "MachineSimulator.h"
+#include "InputStreamer.h"
+#include "RunLengthInput.h"
+#include <algorithm>
 
 MachineConfiguration MachineSimulator::Simulate(const TuringMachine& tm, const std::string& input) {
     MachineConfiguration config = MachineSimulator::initializeConfiguration(tm, input);
-    int step = 0;
+    MachineSimulator::Run(tm, config);
+    return config;
+}
+
+// Returns the number of steps executed.
+long long MachineSimulator::Run(const TuringMachine& tm, MachineConfiguration& config) {
+    long long steps = 0;
+    while (MachineSimulator::Step(tm, config) >= 0) {
+        ++steps;
+    }
+    MachineSimulator::Finish(config);
+    return steps;
+}
+
+// Run with observers notified around every step; see StepObserver.
+long long MachineSimulator::Run(const TuringMachine& tm, MachineConfiguration& config, const std::vector<StepObserver*>& observers) {
+    long long step = 0;
     while (true) {
-        bool matched = false;
-        for (const auto& transition : tm.transitions) {
-            if (transition.oldState != config.currentState) {
-                continue;
-            }
-            if (MachineSimulator::matchSymbols(config, transition.oldSymbols, tm.blankSymbol)) {
-                MachineSimulator::applyTransition(config, transition, tm.blankSymbol);
-                matched = true;
-                break;
-            }
-        }
-        if (!matched) {
+        MachineSimulator::loadHeadCells(config);
+        int fired = MachineSimulator::findTransition(tm, config);
+        if (fired < 0) {
             break;
         }
+        for (StepObserver* observer : observers) {
+            observer->BeforeStep(step, config, fired);
+        }
+        MachineSimulator::applyTransition(config, tm.transitions[static_cast<size_t>(fired)], tm.blankSymbol);
         step = step + 1;
     }
-    return config;
+    for (StepObserver* observer : observers) {
+        observer->OnHalt(step, config);
+    }
+    MachineSimulator::Finish(config);
+    for (StepObserver* observer : observers) {
+        observer->OnFinish(step, config);
+    }
+    return step;
+}
+
+// Fires the first transition matching the current configuration and returns
+// its index in tm.transitions, or -1 when the machine halts.
+int MachineSimulator::Step(const TuringMachine& tm, MachineConfiguration& config) {
+    MachineSimulator::loadHeadCells(config);
+    int fired = MachineSimulator::findTransition(tm, config);
+    if (fired >= 0) {
+        MachineSimulator::applyTransition(config, tm.transitions[static_cast<size_t>(fired)], tm.blankSymbol);
+    }
+    return fired;
+}
+
+int MachineSimulator::findTransition(const TuringMachine& tm, const MachineConfiguration& config) {
+    for (size_t i = 0; i < tm.transitions.size(); ++i) {
+        const Transition& transition = tm.transitions[i];
+        if (transition.oldState != config.currentState) {
+            continue;
+        }
+        if (MachineSimulator::matchSymbols(config, transition.oldSymbols, tm.blankSymbol)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void MachineSimulator::loadHeadCells(MachineConfiguration& config) {
+    for (auto& tape : config.tapes) {
+        if (tape.source && !tape.source->IsLoaded(tape.headPosition)) {
+            tape.source->Fill(tape, tape.headPosition);
+        }
+    }
+}
+
+// Loads and validates the streamed input the machine never reached.
+void MachineSimulator::Finish(MachineConfiguration& config) {
+    for (auto& tape : config.tapes) {
+        if (tape.source) {
+            tape.source->Drain(tape);
+            tape.source.reset();
+        }
+    }
 }
 
 MachineConfiguration MachineSimulator::initializeConfiguration(const TuringMachine& tm, const std::string& input) {
-    std::vector<Tape> tapes;
-    for (int i = 0; i < tm.tapeCount; ++i) {
-        Tape tape;
-        tape.cells.clear();
-        if (i == 0) {
-            for (int j = 0; j < static_cast<int>(input.size()); ++j) {
-                tape.cells[j] = input[static_cast<size_t>(j)];
+    InputRun run;
+    run.symbols = input;
+    run.count = 1;
+    return MachineSimulator::initializeConfiguration(tm, std::vector<InputRun>(1, run));
+}
+
+// Expands the runs into tape 0, sized once up front.
+MachineConfiguration MachineSimulator::initializeConfiguration(const TuringMachine& tm, const std::vector<InputRun>& runs) {
+    std::vector<Tape> tapes(static_cast<size_t>(tm.tapeCount));
+    for (auto& tape : tapes) {
+        tape.blank = tm.blankSymbol;
+        tape.headPosition = 0;
+    }
+    long long length = RunLengthInput::Length(runs);
+    if (!tapes.empty() && length > 0) {
+        Tape& tape = tapes[0];
+        tape.Reserve(0, length - 1);
+        long long position = 0;
+        for (const auto& run : runs) {
+            if (run.symbols.size() == 1) {
+                tape.WriteRepeated(position, run.symbols[0], static_cast<size_t>(run.count));
+                position += run.count;
+                continue;
+            }
+            for (long long k = 0; k < run.count; ++k) {
+                tape.WriteRange(position, run.symbols.data(), run.symbols.size());
+                position += static_cast<long long>(run.symbols.size());
             }
         }
-        tape.headPosition = 0;
-        tapes.push_back(tape);
     }
     MachineConfiguration config;
+    // With room for the longest state name, entering a state never allocates.
+    size_t longest = tm.initialState.size();
+    for (const auto& state : tm.states) {
+        longest = std::max(longest, state.size());
+    }
+    config.currentState.reserve(longest);
     config.currentState = tm.initialState;
-    config.tapes = tapes;
+    config.tapes = std::move(tapes);
     return config;
 }
 
 bool MachineSimulator::matchSymbols(const MachineConfiguration& config, const std::vector<char>& oldSymbols, char blankSymbol) {
     for (size_t i = 0; i < oldSymbols.size(); ++i) {
-        int headPos = config.tapes[i].headPosition;
-        char symbol = blankSymbol;
-        auto it = config.tapes[i].cells.find(headPos);
-        if (it != config.tapes[i].cells.end()) {
-            symbol = it->second;
-        }
+        char symbol = config.tapes[i].Read(config.tapes[i].headPosition);
         char expected = oldSymbols[i];
         if (expected == '*') {
             if (symbol == blankSymbol) {
@@ -67,10 +149,10 @@ bool MachineSimulator::matchSymbols(const MachineConfiguration& config, const st
 void MachineSimulator::applyTransition(MachineConfiguration& config, const Transition& t, char /*blank*/) {
     for (size_t i = 0; i < config.tapes.size(); ++i) {
         Tape& tape = config.tapes[i];
-        int headPos = tape.headPosition;
+        long long headPos = tape.headPosition;
         char writeSymbol = t.newSymbols[i];
         if (writeSymbol != '*') {
-            tape.cells[headPos] = writeSymbol;
+            tape.Write(headPos, writeSymbol);
         }
         Direction direction = t.directions[i];
         if (direction == Direction::LEFT) {
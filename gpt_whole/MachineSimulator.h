@@ -1,11 +1,21 @@
 #pragma once
 #include "types/TuringMachine.h"
 #include "types/MachineConfiguration.h"
+#include "types/InputRun.h"
+#include "StepObserver.h"
+#include <vector>
 
 class MachineSimulator {
 public:
     static MachineConfiguration Simulate(const TuringMachine& tm, const std::string& input);
+    static long long Run(const TuringMachine& tm, MachineConfiguration& config);
+    static long long Run(const TuringMachine& tm, MachineConfiguration& config, const std::vector<StepObserver*>& observers);
+    static int Step(const TuringMachine& tm, MachineConfiguration& config);
+    static void Finish(MachineConfiguration& config);
+    static void loadHeadCells(MachineConfiguration& config);
+    static int findTransition(const TuringMachine& tm, const MachineConfiguration& config);
     static MachineConfiguration initializeConfiguration(const TuringMachine& tm, const std::string& input);
+    static MachineConfiguration initializeConfiguration(const TuringMachine& tm, const std::vector<InputRun>& runs);
     static bool matchSymbols(const MachineConfiguration& config, const std::vector<char>& expectedSymbols, char blank);
     static void applyTransition(MachineConfiguration& config, const Transition& t, char blank);
 };
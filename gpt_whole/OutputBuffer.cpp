@@ -0,0 +1,44 @@
+#include "OutputBuffer.h"
+#include "OutputWriter.h"
+#include <stdexcept>
+
+OutputBuffer::OutputBuffer(int fd, size_t blockSize) : fd(fd), blockSize(blockSize) {
+    buffer.reserve(blockSize * 2);
+}
+
+OutputBuffer::OutputBuffer() : fd(-1), blockSize(static_cast<size_t>(-1)) {
+}
+
+// Write errors are only reported by an explicit Flush.
+OutputBuffer::~OutputBuffer() {
+    try {
+        Flush();
+    } catch (const std::exception&) {
+    }
+}
+
+void OutputBuffer::AppendInt(long long value) {
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    buffer.append(p, static_cast<size_t>(end - p));
+}
+
+void OutputBuffer::Flush() {
+    if (fd >= 0 && !buffer.empty()) {
+        bool written = OutputWriter::WriteAll(fd, buffer);
+        flushed += buffer.size();
+        buffer.clear();
+        if (!written) {
+            throw std::runtime_error("cannot write result");
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+
+// Reusable output buffer written to a file descriptor in large blocks.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(int fd, size_t blockSize = 1 << 20);
+    // Keeps everything in memory for Contents().
+    OutputBuffer();
+    ~OutputBuffer();
+
+    template <size_t N>
+    void Append(const char (&literal)[N]) { buffer.append(literal, N - 1); }
+    void Append(const char* data, size_t size) { buffer.append(data, size); }
+    void Append(const std::string& text) { buffer.append(text); }
+    void Append(char c) { buffer.push_back(c); }
+    void AppendRepeated(char c, size_t count) { buffer.append(count, c); }
+    void AppendInt(long long value);
+
+    // Flushes once a whole block has accumulated; call between records.
+    void MaybeFlush() {
+        if (buffer.size() >= blockSize) Flush();
+    }
+    // Throws if the write fails; the buffered output is dropped either way.
+    void Flush();
+
+    const std::string& Contents() const { return buffer; }
+
+    // Bytes handed to this buffer so far, flushed or not.
+    unsigned long long Offset() const { return flushed + buffer.size(); }
+
+    static int DigitCount(unsigned long long value) {
+        int digits = 1;
+        while (value >= 10) {
+            value /= 10;
+            ++digits;
+        }
+        return digits;
+    }
+
+private:
+    int fd;
+    size_t blockSize;
+    std::string buffer;
+    unsigned long long flushed = 0;
+};
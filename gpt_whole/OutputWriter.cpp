@@ -0,0 +1,52 @@
+#include "OutputWriter.h"
+#include "TraceEvents.h"
+#include <atomic>
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+    std::atomic<unsigned long long> standardBytes[3];
+}
+
+bool OutputWriter::WriteAll(int fd, struct iovec* iov, int count) {
+    TRACE_SPAN("write");
+    while (count > 0) {
+        ssize_t n = ::writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        size_t written = static_cast<size_t>(n);
+        if (fd >= 1 && fd <= 2) {
+            standardBytes[fd].fetch_add(written, std::memory_order_relaxed);
+        }
+        while (count > 0 && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+bool OutputWriter::WriteAll(int fd, const std::string& data) {
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(data.data());
+    iov.iov_len = data.size();
+    return OutputWriter::WriteAll(fd, &iov, 1);
+}
+
+unsigned long long OutputWriter::BytesWritten(int fd) {
+    return (fd >= 1 && fd <= 2) ? standardBytes[fd].load(std::memory_order_relaxed) : 0;
+}
+
+// Appends value as a little-endian integer of the given width.
+void OutputWriter::AppendUint(std::string& out, unsigned long long value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
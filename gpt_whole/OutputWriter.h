@@ -0,0 +1,13 @@
+#pragma once
+#include <string>
+#include <sys/uio.h>
+
+// Writes whole buffers to a file descriptor, retrying short writes and EINTR.
+class OutputWriter {
+public:
+    static bool WriteAll(int fd, struct iovec* iov, int count);
+    static bool WriteAll(int fd, const std::string& data);
+    static void AppendUint(std::string& out, unsigned long long value, int bytes);
+    // Bytes successfully written so far to stdout or stderr (fd 1 or 2).
+    static unsigned long long BytesWritten(int fd);
+};
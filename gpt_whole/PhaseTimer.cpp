@@ -0,0 +1,174 @@
+#include "PhaseTimer.h"
+#include "AllocationCounter.h"
+#include "TraceEvents.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <ctime>
+#include <vector>
+
+namespace {
+    struct Phase {
+        const char* name;
+        double wallMs;
+        double cpuMs;
+        unsigned long long allocations;
+        unsigned long long bytes;
+    };
+
+    struct Counter {
+        const char* name;
+        unsigned long long value;
+    };
+
+    struct State {
+        bool enabled = false;
+        bool spanOpen = false;
+        const char* current = nullptr;
+        std::chrono::steady_clock::time_point wallStart;
+        double cpuStart = 0;
+        unsigned long long allocationsStart = 0;
+        unsigned long long bytesStart = 0;
+        std::vector<Phase> phases;
+        std::vector<Counter> counters;
+    };
+
+    State& Timer() {
+        static State state;
+        return state;
+    }
+
+    // CPU time of the whole process, so writer threads are included.
+    double CpuMs() {
+        struct timespec now;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+        return static_cast<double>(now.tv_sec) * 1e3 + static_cast<double>(now.tv_nsec) / 1e6;
+    }
+}
+
+void PhaseTimer::Enable() {
+    Timer().enabled = true;
+}
+
+// Phases also appear as spans on the main thread's trace-event track.
+void PhaseTimer::Begin(const char* phase) {
+    State& state = Timer();
+    if (state.spanOpen) {
+        TRACE_END();
+    }
+    TRACE_BEGIN(phase);
+    state.spanOpen = true;
+    if (!state.enabled) {
+        return;
+    }
+    PhaseTimer::End();
+    state.current = phase;
+    state.cpuStart = CpuMs();
+    state.allocationsStart = AllocationCounter::Allocations();
+    state.bytesStart = AllocationCounter::Bytes();
+    state.wallStart = std::chrono::steady_clock::now();
+}
+
+void PhaseTimer::End() {
+    State& state = Timer();
+    if (state.spanOpen) {
+        TRACE_END();
+        state.spanOpen = false;
+    }
+    if (!state.enabled || !state.current) {
+        return;
+    }
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double wallMs = std::chrono::duration<double, std::milli>(now - state.wallStart).count();
+    state.phases.push_back(Phase{state.current, wallMs, CpuMs() - state.cpuStart, AllocationCounter::Allocations() - state.allocationsStart,
+                                 AllocationCounter::Bytes() - state.bytesStart});
+    state.current = nullptr;
+}
+
+void PhaseTimer::Count(const char* name, unsigned long long value) {
+    State& state = Timer();
+    if (!state.enabled) {
+        return;
+    }
+    for (auto& counter : state.counters) {
+        if (std::string(counter.name) == name) {
+            counter.value = value;
+            return;
+        }
+    }
+    state.counters.push_back(Counter{name, value});
+}
+
+void PhaseTimer::Report(bool json) {
+    State& state = Timer();
+    if (!state.enabled) {
+        return;
+    }
+    PhaseTimer::End();
+    double wallTotal = 0;
+    double cpuTotal = 0;
+    unsigned long long allocationsTotal = 0;
+    unsigned long long bytesTotal = 0;
+    // Allocations per million steps of the phase that runs the machine.
+    unsigned long long loopAllocations = 0;
+    for (const auto& phase : state.phases) {
+        wallTotal += phase.wallMs;
+        cpuTotal += phase.cpuMs;
+        allocationsTotal += phase.allocations;
+        bytesTotal += phase.bytes;
+        if (std::string(phase.name) == "simulate" || std::string(phase.name) == "trace") {
+            loopAllocations += phase.allocations;
+        }
+    }
+    unsigned long long steps = 0;
+    for (const auto& counter : state.counters) {
+        if (std::string(counter.name) == "steps_executed") {
+            steps = counter.value;
+        }
+    }
+    bool allocations = AllocationCounter::Available();
+    double perMillion = steps == 0 ? 0.0 : static_cast<double>(loopAllocations) * 1e6 / static_cast<double>(steps);
+    if (json) {
+        std::fprintf(stderr, "{\"phases\": [");
+        for (size_t i = 0; i < state.phases.size(); ++i) {
+            const Phase& phase = state.phases[i];
+            std::fprintf(stderr, "%s{\"name\": \"%s\", \"wall_ms\": %.3f, \"cpu_ms\": %.3f", i == 0 ? "" : ", ", phase.name, phase.wallMs, phase.cpuMs);
+            if (allocations) {
+                std::fprintf(stderr, ", \"allocations\": %llu, \"allocated_bytes\": %llu", phase.allocations, phase.bytes);
+            }
+            std::fprintf(stderr, "}");
+        }
+        std::fprintf(stderr, "], \"wall_ms\": %.3f, \"cpu_ms\": %.3f", wallTotal, cpuTotal);
+        if (allocations) {
+            std::fprintf(stderr, ", \"allocations\": %llu, \"allocated_bytes\": %llu, \"allocations_per_million_steps\": %.3f",
+                         allocationsTotal, bytesTotal, perMillion);
+        }
+        for (const auto& counter : state.counters) {
+            std::fprintf(stderr, ", \"%s\": %llu", counter.name, counter.value);
+        }
+        std::fprintf(stderr, "}\n");
+        return;
+    }
+    std::fprintf(stderr, "==================== TIMINGS ====================\n");
+    if (allocations) {
+        std::fprintf(stderr, "%-12s %12s %12s %12s %14s\n", "phase", "wall ms", "cpu ms", "allocs", "alloc bytes");
+        for (const auto& phase : state.phases) {
+            std::fprintf(stderr, "%-12s %12.3f %12.3f %12llu %14llu\n", phase.name, phase.wallMs, phase.cpuMs, phase.allocations, phase.bytes);
+        }
+        std::fprintf(stderr, "%-12s %12.3f %12.3f %12llu %14llu\n", "total", wallTotal, cpuTotal, allocationsTotal, bytesTotal);
+        std::fprintf(stderr, "%-19s: %.3f\n", "allocs per Msteps", perMillion);
+    } else {
+        std::fprintf(stderr, "%-12s %12s %12s\n", "phase", "wall ms", "cpu ms");
+        for (const auto& phase : state.phases) {
+            std::fprintf(stderr, "%-12s %12.3f %12.3f\n", phase.name, phase.wallMs, phase.cpuMs);
+        }
+        std::fprintf(stderr, "%-12s %12.3f %12.3f\n", "total", wallTotal, cpuTotal);
+    }
+    for (const auto& counter : state.counters) {
+        std::string label(counter.name);
+        for (char& c : label) {
+            if (c == '_') c = ' ';
+        }
+        std::fprintf(stderr, "%-19s: %llu\n", label.c_str(), counter.value);
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+
+// Wall and CPU time per phase plus named counters, reported by --timings.
+// Begin ends the current phase.
+class PhaseTimer {
+public:
+    static void Enable();
+    static void Begin(const char* phase);
+    static void End();
+    // Counter names use underscores; the text report prints them as spaces.
+    static void Count(const char* name, unsigned long long value);
+    static void Report(bool json);
+};
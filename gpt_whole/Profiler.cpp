@@ -0,0 +1,111 @@
+#include "Profiler.h"
+#include "TextFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+Profiler::Profiler(const TuringMachine& tm, const std::string& jsonPath)
+    : tm(tm), jsonPath(jsonPath), fired(tm.transitions.size(), 0) {
+}
+
+void Profiler::OnFinish(long long steps, const MachineConfiguration& config) {
+    printText(steps, config.currentState);
+    if (!jsonPath.empty()) {
+        writeJson(steps, config.currentState);
+    }
+}
+
+std::vector<Profiler::StateCount> Profiler::stateCounts() const {
+    std::map<std::string, unsigned long long> byState;
+    for (const auto& state : tm.states) {
+        byState[state] = 0;
+    }
+    for (size_t i = 0; i < fired.size(); ++i) {
+        byState[tm.transitions[i].oldState] += fired[i];
+    }
+    std::vector<StateCount> counts;
+    for (const auto& entry : byState) {
+        counts.push_back(StateCount{entry.first, entry.second});
+    }
+    std::stable_sort(counts.begin(), counts.end(), [](const StateCount& a, const StateCount& b) {
+        return a.steps > b.steps;
+    });
+    return counts;
+}
+
+// Transition indices, most fired first; ties keep file order.
+std::vector<size_t> Profiler::byFires() const {
+    std::vector<size_t> order(fired.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return fired[a] > fired[b];
+    });
+    return order;
+}
+
+// The transition as written in the .tm file.
+std::string Profiler::rule(size_t index) const {
+    const Transition& t = tm.transitions[index];
+    std::string text = t.oldState + " " + std::string(t.oldSymbols.begin(), t.oldSymbols.end()) + " "
+                       + std::string(t.newSymbols.begin(), t.newSymbols.end()) + " ";
+    for (Direction d : t.directions) {
+        text.push_back(d == Direction::LEFT ? 'l' : (d == Direction::RIGHT ? 'r' : '*'));
+    }
+    return text + " " + t.newState;
+}
+
+void Profiler::printText(long long steps, const std::string& finalState) const {
+    unsigned long long total = static_cast<unsigned long long>(steps);
+    unsigned long long examined = tm.transitions.size();
+    for (size_t i = 0; i < fired.size(); ++i) {
+        examined += fired[i] * (i + 1);
+    }
+    std::string out;
+    out += "==================== PROFILE ====================\n";
+    out += "steps    : " + std::to_string(total) + " (halted in " + finalState + ")\n";
+    out += "examined : " + std::to_string(examined) + " candidate transitions";
+    if (total > 0) {
+        char perStep[32];
+        std::snprintf(perStep, sizeof(perStep), " (%.2f per step)", static_cast<double>(examined) / static_cast<double>(total + 1));
+        out += perStep;
+    }
+    out += "\n\n           steps   share  state\n";
+    for (const auto& count : stateCounts()) {
+        out += TextFormat::Padded(count.steps, 16) + "  " + TextFormat::Percent(count.steps, total) + "  " + count.state + "\n";
+    }
+    out += "\n           fires   share  examined  line  transition\n";
+    for (size_t i : byFires()) {
+        out += TextFormat::Padded(fired[i], 16) + "  " + TextFormat::Percent(fired[i], total) + "  " + TextFormat::Padded(i + 1, 8) + "  "
+               + TextFormat::Padded(static_cast<unsigned long long>(tm.transitions[i].line), 4) + "  " + rule(i) + "\n";
+    }
+    std::fputs(out.c_str(), stderr);
+}
+
+void Profiler::writeJson(long long steps, const std::string& finalState) const {
+    std::ofstream fout(jsonPath.c_str());
+    if (!fout) {
+        throw std::runtime_error("cannot write " + jsonPath);
+    }
+    unsigned long long examined = tm.transitions.size();
+    for (size_t i = 0; i < fired.size(); ++i) {
+        examined += fired[i] * (i + 1);
+    }
+    fout << "{\n  \"steps\": " << steps << ",\n  \"finalState\": " << TextFormat::JsonString(finalState)
+         << ",\n  \"candidatesExamined\": " << examined << ",\n  \"states\": [";
+    std::vector<StateCount> counts = stateCounts();
+    for (size_t i = 0; i < counts.size(); ++i) {
+        fout << (i == 0 ? "\n" : ",\n") << "    {\"state\": " << TextFormat::JsonString(counts[i].state) << ", \"steps\": " << counts[i].steps << "}";
+    }
+    fout << "\n  ],\n  \"transitions\": [";
+    std::vector<size_t> order = byFires();
+    for (size_t k = 0; k < order.size(); ++k) {
+        size_t i = order[k];
+        fout << (k == 0 ? "\n" : ",\n") << "    {\"index\": " << i << ", \"line\": " << tm.transitions[i].line
+             << ", \"rule\": " << TextFormat::JsonString(rule(i)) << ", \"fires\": " << fired[i] << ", \"examinedPerFire\": " << (i + 1) << "}";
+    }
+    fout << "\n  ]\n}\n";
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "StepObserver.h"
+#include "types/TuringMachine.h"
+#include <string>
+#include <vector>
+
+// --profile: counts the fires of each transition. Since transitions are
+// scanned in order, firing transition i examined i + 1 candidates.
+class Profiler : public StepObserver {
+public:
+    Profiler(const TuringMachine& tm, const std::string& jsonPath);
+
+    void BeforeStep(long long /*step*/, const MachineConfiguration& /*config*/, int transitionIndex) {
+        ++fired[static_cast<size_t>(transitionIndex)];
+    }
+    void OnFinish(long long steps, const MachineConfiguration& config);
+
+private:
+    struct StateCount {
+        std::string state;
+        unsigned long long steps;
+    };
+
+    std::vector<StateCount> stateCounts() const;
+    std::vector<size_t> byFires() const;
+    std::string rule(size_t index) const;
+    void printText(long long steps, const std::string& finalState) const;
+    void writeJson(long long steps, const std::string& finalState) const;
+
+    const TuringMachine& tm;
+    std::string jsonPath;
+    std::vector<unsigned long long> fired;
+};
@@ -0,0 +1,123 @@
+#include "ProgressReporter.h"
+#include "OutputBuffer.h"
+#include "TraceEvents.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace {
+    // Resident set size in bytes, or -1 if /proc is unavailable.
+    long long ResidentBytes() {
+        FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (!statm) {
+            return -1;
+        }
+        long long pages = 0;
+        long long resident = -1;
+        if (std::fscanf(statm, "%lld %lld", &pages, &resident) != 2) {
+            resident = -1;
+        }
+        std::fclose(statm);
+        return resident < 0 ? -1 : resident * static_cast<long long>(sysconf(_SC_PAGESIZE));
+    }
+}
+
+// SIGUSR1 is blocked and taken by the reporting thread with sigtimedwait,
+// which doubles as its interval timer.
+ProgressReporter::ProgressReporter(const TuringMachine& tm, size_t tapeCount, long long intervalMs)
+    : tm(tm), tapeCount(tapeCount), intervalMs(intervalMs), bounds(new std::atomic<long long>[tapeCount * 2]) {
+    for (size_t i = 0; i < tapeCount * 2; ++i) {
+        bounds[i].store(0, std::memory_order_relaxed);
+    }
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &mask, &previousMask);
+    start = std::chrono::steady_clock::now();
+    reporter = std::thread(&ProgressReporter::run, this);
+}
+
+ProgressReporter::~ProgressReporter() {
+    stop.store(true, std::memory_order_relaxed);
+    pthread_kill(reporter.native_handle(), SIGUSR1);
+    reporter.join();
+    pthread_sigmask(SIG_SETMASK, &previousMask, nullptr);
+}
+
+void ProgressReporter::publishBounds(const MachineConfiguration& config) {
+    for (size_t i = 0; i < tapeCount; ++i) {
+        bounds[2 * i].store(config.tapes[i].left, std::memory_order_relaxed);
+        bounds[2 * i + 1].store(config.tapes[i].right, std::memory_order_relaxed);
+    }
+}
+
+void ProgressReporter::OnHalt(long long steps, MachineConfiguration& config) {
+    publishBounds(config);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report(steps, config.currentState, seconds > 0 ? static_cast<double>(steps) / seconds : 0.0);
+}
+
+void ProgressReporter::run() {
+    TRACE_THREAD_NAME("progress");
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    struct timespec interval;
+    interval.tv_sec = static_cast<time_t>(intervalMs / 1000);
+    interval.tv_nsec = static_cast<long>((intervalMs % 1000) * 1000000);
+    long long lastStep = 0;
+    std::chrono::steady_clock::time_point last = start;
+    while (true) {
+        int signal = sigtimedwait(&mask, nullptr, &interval);
+        if (signal < 0 && errno == EINTR) {
+            continue;
+        }
+        if (stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        long long step = publishedStep.load(std::memory_order_relaxed);
+        int fired = transition.load(std::memory_order_relaxed);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - last).count();
+        double rate = seconds > 0 ? static_cast<double>(step - lastStep) / seconds : 0.0;
+        report(step, fired < 0 ? std::string("-") : tm.transitions[static_cast<size_t>(fired)].oldState, rate);
+        lastStep = step;
+        last = now;
+    }
+}
+
+void ProgressReporter::report(long long step, const std::string& state, double rate) const {
+    OutputBuffer out(STDERR_FILENO);
+    char number[32];
+    out.Append("progress: step ");
+    out.AppendInt(step);
+    std::snprintf(number, sizeof(number), "%.3g", rate);
+    out.Append(", ");
+    out.Append(number, std::strlen(number));
+    out.Append(" steps/s, state ");
+    out.Append(state);
+    for (size_t i = 0; i < tapeCount; ++i) {
+        long long left = bounds[2 * i].load(std::memory_order_relaxed);
+        long long right = bounds[2 * i + 1].load(std::memory_order_relaxed);
+        out.Append(", tape");
+        out.AppendInt(static_cast<long long>(i));
+        out.Append(' ');
+        if (left > right) {
+            out.Append("empty");
+        } else {
+            out.AppendInt(left);
+            out.Append("..");
+            out.AppendInt(right);
+        }
+    }
+    long long resident = ResidentBytes();
+    if (resident >= 0) {
+        out.Append(", rss ");
+        out.AppendInt(resident >> 10);
+        out.Append(" KiB");
+    }
+    out.Append('\n');
+}
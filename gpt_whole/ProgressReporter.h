@@ -0,0 +1,41 @@
+#pragma once
+#include "StepObserver.h"
+#include "types/TuringMachine.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <signal.h>
+
+// --progress: prints a status line to stderr every intervalMs and on SIGUSR1,
+// from a thread reading counters the run publishes every 1024 steps.
+class ProgressReporter : public StepObserver {
+public:
+    ProgressReporter(const TuringMachine& tm, size_t tapeCount, long long intervalMs);
+    ~ProgressReporter();
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) {
+        if ((step & 1023) == 0) {
+            publishedStep.store(step, std::memory_order_relaxed);
+            transition.store(transitionIndex, std::memory_order_relaxed);
+            publishBounds(config);
+        }
+    }
+    void OnHalt(long long steps, MachineConfiguration& config);
+
+private:
+    void publishBounds(const MachineConfiguration& config);
+    void run();
+    void report(long long step, const std::string& state, double rate) const;
+
+    const TuringMachine& tm;
+    size_t tapeCount;
+    long long intervalMs;
+    std::atomic<long long> publishedStep{0};
+    std::atomic<int> transition{-1};
+    std::unique_ptr<std::atomic<long long>[]> bounds;
+    std::atomic<bool> stop{false};
+    std::chrono::steady_clock::time_point start;
+    sigset_t previousMask;
+    std::thread reporter;
+};
@@ -1,110 +1,192 @@
 #include "ResultPrinter.h"
+#include "OutputWriter.h"
+#include "OutputBuffer.h"
 #include <iostream>
-#include <set>
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
+#include <stdexcept>
 #include <vector>
+#include <unistd.h>
 
-void ResultPrinter::PrintFinalResult(const MachineConfiguration& config) {
-    const Tape& tape = config.tapes[0];
-    std::vector<int> indices;
-    indices.reserve(tape.cells.size());
-    for (const auto& kv : tape.cells) {
-        indices.push_back(kv.first);
+namespace {
+    // The written part of the tape without leading and trailing blanks.
+    std::pair<const char*, size_t> TrimmedContents(const Tape& tape) {
+        if (tape.Empty()) {
+            return std::make_pair(static_cast<const char*>(nullptr), static_cast<size_t>(0));
+        }
+        const char* begin = tape.cells.data() + (tape.left - tape.origin);
+        const char* end = tape.cells.data() + (tape.right - tape.origin) + 1;
+        while (begin < end && *begin == tape.blank) ++begin;
+        while (end > begin && *(end - 1) == tape.blank) --end;
+        return std::make_pair(begin, static_cast<size_t>(end - begin));
+    }
+
+    void CheckWritten(bool written) {
+        if (!written) {
+            throw std::runtime_error("cannot write result");
+        }
     }
-    std::sort(indices.begin(), indices.end());
-    if (indices.empty()) {
-        std::cout << "" << std::endl;
-        return;
+
+    OutputBuffer& VerboseOutput() {
+        static OutputBuffer output(STDOUT_FILENO);
+        return output;
     }
-    int left = indices.front();
-    int right = indices.back();
+}
+
+// One gather write of the tape storage and the newline.
+void ResultPrinter::PrintFinalResult(const MachineConfiguration& config) {
+    std::pair<const char*, size_t> contents = TrimmedContents(config.tapes[0]);
+    char newline = '\n';
+    struct iovec iov[2];
+    iov[0].iov_base = const_cast<char*>(contents.first);
+    iov[0].iov_len = contents.second;
+    iov[1].iov_base = &newline;
+    iov[1].iov_len = 1;
+    std::cout.flush();
+    CheckWritten(OutputWriter::WriteAll(STDOUT_FILENO, contents.second > 0 ? iov : iov + 1, contents.second > 0 ? 2 : 1));
+}
+
+void ResultPrinter::PrintFinalResult(const MachineConfiguration& config, OutputFormat format) {
+    if (format == OutputFormat::RLE) {
+        ResultPrinter::printRunLengthResult(config);
+    } else if (format == OutputFormat::BINARY) {
+        ResultPrinter::printBinaryResult(config);
+    } else {
+        ResultPrinter::PrintFinalResult(config);
+    }
+}
+
+// Prints the trimmed result as "<symbol>*<count>" runs separated by spaces,
+// the same syntax --input-rle accepts.
+void ResultPrinter::printRunLengthResult(const MachineConfiguration& config) {
+    std::pair<const char*, size_t> contents = TrimmedContents(config.tapes[0]);
     std::string output;
-    for (int i = left; i <= right; ++i) {
-        auto it = tape.cells.find(i);
-        char symbol = (it != tape.cells.end()) ? it->second : '_';
+    size_t i = 0;
+    while (i < contents.second) {
+        char symbol = contents.first[i];
+        size_t j = i + 1;
+        while (j < contents.second && contents.first[j] == symbol) ++j;
+        if (!output.empty()) output.push_back(' ');
         output.push_back(symbol);
+        output.push_back('*');
+        output += std::to_string(j - i);
+        i = j;
+    }
+    output.push_back('\n');
+    std::cout.flush();
+    CheckWritten(OutputWriter::WriteAll(STDOUT_FILENO, output));
+}
+
+// "TMR1", u32 state length, state, u32 tape count, then per tape
+// i64 head, i64 first position, u64 cell count, cells (little-endian).
+void ResultPrinter::printBinaryResult(const MachineConfiguration& config) {
+    std::string header("TMR1");
+    OutputWriter::AppendUint(header, config.currentState.size(), 4);
+    header += config.currentState;
+    OutputWriter::AppendUint(header, config.tapes.size(), 4);
+    std::cout.flush();
+    CheckWritten(OutputWriter::WriteAll(STDOUT_FILENO, header));
+    for (const auto& tape : config.tapes) {
+        long long first = tape.Empty() ? 0 : tape.left;
+        unsigned long long count = tape.Empty() ? 0 : static_cast<unsigned long long>(tape.right - tape.left + 1);
+        std::string tapeHeader;
+        OutputWriter::AppendUint(tapeHeader, static_cast<unsigned long long>(tape.headPosition), 8);
+        OutputWriter::AppendUint(tapeHeader, static_cast<unsigned long long>(first), 8);
+        OutputWriter::AppendUint(tapeHeader, count, 8);
+        struct iovec iov[2];
+        iov[0].iov_base = const_cast<char*>(tapeHeader.data());
+        iov[0].iov_len = tapeHeader.size();
+        iov[1].iov_base = const_cast<char*>(tape.cells.data() + (first - tape.origin));
+        iov[1].iov_len = static_cast<size_t>(count);
+        CheckWritten(OutputWriter::WriteAll(STDOUT_FILENO, iov, count > 0 ? 2 : 1));
     }
-    std::cout << output << std::endl;
 }
 
 void ResultPrinter::PrintVerboseStart(const std::string& inputString) {
-    std::cout << "Input: " << inputString << std::endl;
-    std::cout << "==================== RUN ====================" << std::endl;
+    std::cout.flush();
+    OutputBuffer& out = VerboseOutput();
+    out.Append("Input: ");
+    out.Append(inputString);
+    out.Append("\n==================== RUN ====================\n");
 }
 
-void ResultPrinter::PrintVerboseStep(int step, const MachineConfiguration& config) {
-    std::cout << "Step   : " << step << std::endl;
-    std::cout << "State  : " << config.currentState << std::endl;
+void ResultPrinter::PrintVerboseStep(long long step, const MachineConfiguration& config) {
+    ResultPrinter::PrintVerboseStep(step, config, -1);
+}
+
+void ResultPrinter::PrintVerboseStep(long long step, const MachineConfiguration& config, long long window) {
+    ResultPrinter::RenderVerboseStep(VerboseOutput(), step, config, window);
+}
+
+// With window K >= 0 only K cells either side of each head are shown.
+void ResultPrinter::RenderVerboseStep(OutputBuffer& out, long long step, const MachineConfiguration& config, long long window) {
+    out.Append("Step   : ");
+    out.AppendInt(step);
+    out.Append("\nState  : ");
+    out.Append(config.currentState);
+    out.Append('\n');
     for (size_t i = 0; i < config.tapes.size(); ++i) {
         const Tape& tape = config.tapes[i];
-        int head = tape.headPosition;
-        std::vector<int> indices;
-        indices.reserve(tape.cells.size() + 1);
-        for (const auto& kv : tape.cells) {
-            indices.push_back(kv.first);
+        long long head = tape.headPosition;
+        long long left = tape.Empty() ? head : std::min(tape.left, head);
+        long long right = tape.Empty() ? head : std::max(tape.right, head);
+        bool elidedLeft = false;
+        bool elidedRight = false;
+        if (window >= 0) {
+            elidedLeft = left < head - window;
+            elidedRight = right > head + window;
+            left = std::max(left, head - window);
+            right = std::min(right, head + window);
         }
-        indices.push_back(head);
-        std::sort(indices.begin(), indices.end());
-        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
-        int left = indices.front();
-        int right = indices.back();
-
-        std::ostringstream indexLine;
-        std::ostringstream symbolLine;
-        std::ostringstream headLine;
 
-        indexLine << "Index" << i << " :";
-        symbolLine << "Tape" << i << "  :";
-        headLine << "Head" << i << "  :";
-
-        for (int j = left; j <= right; ++j) {
-            int aj = j < 0 ? -j : j;
-            std::string indexStr = std::to_string(aj);
-            char symbol = '_';
-            auto it = tape.cells.find(j);
-            if (it != tape.cells.end()) symbol = it->second;
-
-            bool isHead = (j == head);
-            std::string pad(indexStr.size(), ' ');
-
-            indexLine << " " << indexStr;
-            symbolLine << pad << symbol;
-            if (isHead) {
-                headLine << pad << "^";
-            } else {
-                headLine << pad << " ";
-            }
+        out.Append("Index");
+        out.AppendInt(static_cast<long long>(i));
+        out.Append(" :");
+        if (elidedLeft) out.Append(" ...");
+        for (long long j = left; j <= right; ++j) {
+            out.Append(' ');
+            out.AppendInt(j < 0 ? -j : j);
         }
-
-        std::cout << indexLine.str() << std::endl;
-        std::cout << symbolLine.str() << std::endl;
-        std::cout << headLine.str() << std::endl;
+        if (elidedRight) out.Append(" ...");
+        out.Append("\nTape");
+        out.AppendInt(static_cast<long long>(i));
+        out.Append("  :");
+        if (elidedLeft) out.Append(" ...");
+        for (long long j = left; j <= right; ++j) {
+            out.AppendRepeated(' ', static_cast<size_t>(OutputBuffer::DigitCount(static_cast<unsigned long long>(j < 0 ? -j : j))));
+            out.Append(tape.Read(j));
+        }
+        if (elidedRight) out.Append(" ...");
+        out.Append("\nHead");
+        out.AppendInt(static_cast<long long>(i));
+        out.Append("  :");
+        if (elidedLeft) out.Append("    ");
+        for (long long j = left; j <= right; ++j) {
+            out.AppendRepeated(' ', static_cast<size_t>(OutputBuffer::DigitCount(static_cast<unsigned long long>(j < 0 ? -j : j))));
+            out.Append(j == head ? '^' : ' ');
+        }
+        if (elidedRight) out.Append("    ");
+        out.Append('\n');
     }
-    std::cout << "---------------------------------------------" << std::endl;
+    out.Append("---------------------------------------------\n");
+    out.MaybeFlush();
 }
 
 void ResultPrinter::PrintVerboseResult(const MachineConfiguration& config) {
+    OutputBuffer& out = VerboseOutput();
+    ResultPrinter::RenderVerboseResult(out, config);
+    out.Flush();
+}
+
+// The verbose result shows the whole written range, blanks included.
+void ResultPrinter::RenderVerboseResult(OutputBuffer& out, const MachineConfiguration& config) {
     const Tape& tape = config.tapes[0];
-    std::vector<int> indices;
-    indices.reserve(tape.cells.size());
-    for (const auto& kv : tape.cells) {
-        indices.push_back(kv.first);
+    out.Append("Result: ");
+    if (!tape.Empty()) {
+        out.Append(tape.cells.data() + (tape.left - tape.origin), static_cast<size_t>(tape.right - tape.left + 1));
     }
-    std::sort(indices.begin(), indices.end());
-    if (indices.empty()) {
-        std::cout << "Result: " << std::endl;
-    } else {
-        int left = indices.front();
-        int right = indices.back();
-        std::string output;
-        for (int i = left; i <= right; ++i) {
-            auto it = tape.cells.find(i);
-            char symbol = (it != tape.cells.end()) ? it->second : '_';
-            output.push_back(symbol);
-        }
-        std::cout << "Result: " << output << std::endl;
-    }
-    std::cout << "==================== END ====================" << std::endl;
+    out.Append("\n==================== END ====================\n");
+}
+
+void ResultPrinter::FlushVerbose() {
+    VerboseOutput().Flush();
 }
\ No newline at end of file
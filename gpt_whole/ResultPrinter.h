@@ -1,11 +1,22 @@
 #pragma once
 #include "types/MachineConfiguration.h"
+#include "types/OutputFormat.h"
+#include "OutputBuffer.h"
 #include <string>
 
 class ResultPrinter {
 public:
     static void PrintFinalResult(const MachineConfiguration& config);
+    static void PrintFinalResult(const MachineConfiguration& config, OutputFormat format);
     static void PrintVerboseStart(const std::string& input);
-    static void PrintVerboseStep(int step, const MachineConfiguration& config);
+    static void PrintVerboseStep(long long step, const MachineConfiguration& config);
+    static void PrintVerboseStep(long long step, const MachineConfiguration& config, long long window);
+    static void RenderVerboseStep(OutputBuffer& out, long long step, const MachineConfiguration& config, long long window);
     static void PrintVerboseResult(const MachineConfiguration& config);
+    static void RenderVerboseResult(OutputBuffer& out, const MachineConfiguration& config);
+    static void FlushVerbose();
+
+private:
+    static void printRunLengthResult(const MachineConfiguration& config);
+    static void printBinaryResult(const MachineConfiguration& config);
 };
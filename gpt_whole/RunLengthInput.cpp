@@ -0,0 +1,59 @@
+#include "RunLengthInput.h"
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+
+std::vector<InputRun> RunLengthInput::Parse(const std::string& spec) {
+    std::vector<InputRun> runs;
+    std::istringstream iss(spec);
+    std::string token;
+    while (iss >> token) {
+        InputRun run;
+        size_t star = token.rfind('*');
+        if (star == std::string::npos) {
+            run.symbols = token;
+            run.count = 1;
+        } else {
+            run.symbols = token.substr(0, star);
+            std::string countText = token.substr(star + 1);
+            if (run.symbols.empty() || countText.empty() || countText.size() > 18) {
+                throw std::runtime_error("illegal input");
+            }
+            for (char c : countText) {
+                if (!std::isdigit(static_cast<unsigned char>(c))) {
+                    throw std::runtime_error("illegal input");
+                }
+            }
+            run.count = std::stoll(countText);
+        }
+        runs.push_back(run);
+    }
+    long long total = 0;
+    for (const auto& run : runs) {
+        long long width = static_cast<long long>(run.symbols.size());
+        if (run.count > (MaxLength - total) / width) {
+            throw std::length_error("input expands to more than " + std::to_string(MaxLength) + " symbols");
+        }
+        total += width * run.count;
+    }
+    return runs;
+}
+
+long long RunLengthInput::Length(const std::vector<InputRun>& runs) {
+    long long total = 0;
+    for (const auto& run : runs) {
+        total += static_cast<long long>(run.symbols.size()) * run.count;
+    }
+    return total;
+}
+
+std::string RunLengthInput::Expand(const std::vector<InputRun>& runs) {
+    std::string input;
+    input.reserve(static_cast<size_t>(RunLengthInput::Length(runs)));
+    for (const auto& run : runs) {
+        for (long long i = 0; i < run.count; ++i) {
+            input += run.symbols;
+        }
+    }
+    return input;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+#include "types/InputRun.h"
+#include <string>
+#include <vector>
+
+// Parses --input-rle specifications such as "a*5000000 b*5000000".
+class RunLengthInput {
+public:
+    // Longest expanded input accepted; Parse throws std::length_error beyond it.
+    static const long long MaxLength = 1LL << 32;
+
+    static std::vector<InputRun> Parse(const std::string& spec);
+    static long long Length(const std::vector<InputRun>& runs);
+    static std::string Expand(const std::vector<InputRun>& runs);
+};
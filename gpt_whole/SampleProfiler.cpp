@@ -0,0 +1,231 @@
+#include "SampleProfiler.h"
+#include "OutputBuffer.h"
+#include "TextFormat.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <map>
+#include <vector>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+    // At most this many samples are kept; later ones are only counted.
+    const size_t SampleCapacity = 1 << 20;
+
+    SampleProfiler* volatile active = nullptr;
+
+    long long FloorDiv(long long value, long long divisor) {
+        long long quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
+
+    // Flame graph frames are separated by ';'.
+    std::string Frame(const std::string& name) {
+        std::string frame = name;
+        std::replace(frame.begin(), frame.end(), ';', ':');
+        return frame;
+    }
+}
+
+// A sample is the head positions and state length, then up to stateWidth
+// bytes of the state name.
+SampleProfiler::SampleProfiler(const TuringMachine& tm, const MachineConfiguration& config, const std::string& foldedPath, long long rate)
+    : tm(tm), config(config), tapes(config.tapes.size()), stateWidth(0), foldedPath(foldedPath), rate(rate), capacity(SampleCapacity) {
+    if (active) {
+        throw std::runtime_error("sampling profiler already running");
+    }
+    for (const auto& state : tm.states) {
+        stateWidth = std::max(stateWidth, state.size());
+    }
+    stride = (tapes + 1) * sizeof(long long) + (stateWidth + sizeof(long long) - 1) / sizeof(long long) * sizeof(long long);
+    void* buffer = mmap(nullptr, capacity * stride, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (buffer == MAP_FAILED) {
+        throw std::runtime_error("cannot reserve sample buffer");
+    }
+    samples = static_cast<char*>(buffer);
+    struct sigaction action;
+    action.sa_handler = &SampleProfiler::handle;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGPROF, &action, &previousAction);
+
+    // Only the simulating thread's CPU time is measured and interrupted.
+    struct sigevent event;
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_value.sival_ptr = nullptr;
+    event.sigev_notify_thread_id = static_cast<pid_t>(syscall(SYS_gettid));
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) != 0) {
+        sigaction(SIGPROF, &previousAction, nullptr);
+        munmap(samples, capacity * stride);
+        throw std::runtime_error("cannot create sampling timer");
+    }
+    active = this;
+    struct itimerspec interval;
+    interval.it_interval.tv_sec = static_cast<time_t>(1 / rate);
+    interval.it_interval.tv_nsec = static_cast<long>(1000000000LL / rate % 1000000000LL);
+    interval.it_value = interval.it_interval;
+    timer_settime(timer, 0, &interval, nullptr);
+    running = true;
+}
+
+SampleProfiler::~SampleProfiler() {
+    stop();
+    munmap(samples, capacity * stride);
+}
+
+void SampleProfiler::handle(int /*signal*/) {
+    SampleProfiler* profiler = active;
+    if (!profiler) {
+        return;
+    }
+    size_t taken = profiler->count;
+    if (taken == profiler->capacity) {
+        profiler->dropped = profiler->dropped + 1;
+        return;
+    }
+    char* sample = profiler->samples + taken * profiler->stride;
+    long long* numbers = reinterpret_cast<long long*>(sample);
+    const MachineConfiguration& config = profiler->config;
+    for (size_t i = 0; i < profiler->tapes; ++i) {
+        numbers[i] = config.tapes[i].headPosition;
+    }
+    size_t length = config.currentState.size();
+    numbers[profiler->tapes] = static_cast<long long>(length);
+    const char* name = config.currentState.data();
+    std::copy(name, name + std::min(length, profiler->stateWidth), sample + (profiler->tapes + 1) * sizeof(long long));
+    profiler->count = taken + 1;
+}
+
+void SampleProfiler::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    timer_delete(timer);
+    active = nullptr;
+    sigaction(SIGPROF, &previousAction, nullptr);
+}
+
+void SampleProfiler::Finish() {
+    stop();
+    report();
+}
+
+// At most 64 power-of-two-wide regions per tape.
+void SampleProfiler::report() const {
+    size_t taken = count;
+    std::vector<long long> regionWidth(tapes, 1);
+    for (size_t t = 0; t < tapes; ++t) {
+        long long lowest = 0;
+        long long highest = 0;
+        for (size_t s = 0; s < taken; ++s) {
+            long long head = reinterpret_cast<const long long*>(samples + s * stride)[t];
+            lowest = s == 0 ? head : std::min(lowest, head);
+            highest = s == 0 ? head : std::max(highest, head);
+        }
+        while ((highest - lowest) / regionWidth[t] >= 64) {
+            regionWidth[t] *= 2;
+        }
+    }
+
+    std::map<std::string, size_t> stacks;
+    std::map<std::string, size_t> byState;
+    std::vector<std::map<long long, size_t>> byRegion(tapes);
+    size_t unattributed = 0;
+    for (size_t s = 0; s < taken; ++s) {
+        const long long* numbers = reinterpret_cast<const long long*>(samples + s * stride);
+        size_t length = static_cast<size_t>(numbers[tapes]);
+        std::string state;
+        if (length <= stateWidth) {
+            state.assign(samples + s * stride + (tapes + 1) * sizeof(long long), length);
+        }
+        if (tm.states.find(state) == tm.states.end()) {
+            ++unattributed;
+            continue;
+        }
+        std::string stack = Frame(state);
+        for (size_t tape = 0; tape < tapes; ++tape) {
+            long long start = FloorDiv(numbers[tape], regionWidth[tape]) * regionWidth[tape];
+            stack += ";tape" + std::to_string(tape) + " " + std::to_string(start) + ".." + std::to_string(start + regionWidth[tape] - 1);
+            ++byRegion[tape][start];
+        }
+        ++stacks[stack];
+        ++byState[state];
+    }
+
+    if (!foldedPath.empty()) {
+        int fd = open(foldedPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("cannot write " + foldedPath);
+        }
+        {
+            OutputBuffer out(fd);
+            for (const auto& entry : stacks) {
+                out.Append(entry.first);
+                out.Append(' ');
+                out.AppendInt(static_cast<long long>(entry.second));
+                out.Append('\n');
+            }
+        }
+        close(fd);
+    }
+
+    OutputBuffer out(STDERR_FILENO);
+    out.Append("sample: ");
+    out.AppendInt(static_cast<long long>(taken));
+    out.Append(" samples at ");
+    out.AppendInt(rate);
+    out.Append(" Hz");
+    if (dropped > 0) {
+        out.Append(", ");
+        out.AppendInt(static_cast<long long>(dropped));
+        out.Append(" dropped");
+    }
+    if (unattributed > 0) {
+        out.Append(", ");
+        out.AppendInt(static_cast<long long>(unattributed));
+        out.Append(" unattributed");
+    }
+    out.Append('\n');
+    std::vector<std::pair<size_t, std::string>> states;
+    for (const auto& entry : byState) {
+        states.push_back(std::make_pair(entry.second, entry.first));
+    }
+    std::stable_sort(states.begin(), states.end(), [](const std::pair<size_t, std::string>& a, const std::pair<size_t, std::string>& b) {
+        return a.first > b.first;
+    });
+    for (size_t i = 0; i < states.size() && i < 10; ++i) {
+        out.Append("  ");
+        out.Append(TextFormat::Percent(states[i].first, taken));
+        out.Append("  state ");
+        out.Append(states[i].second);
+        out.Append('\n');
+    }
+    for (size_t tape = 0; tape < tapes; ++tape) {
+        std::vector<std::pair<size_t, long long>> regions;
+        for (const auto& entry : byRegion[tape]) {
+            regions.push_back(std::make_pair(entry.second, entry.first));
+        }
+        std::stable_sort(regions.begin(), regions.end(), [](const std::pair<size_t, long long>& a, const std::pair<size_t, long long>& b) {
+            return a.first > b.first;
+        });
+        for (size_t i = 0; i < regions.size() && i < 5; ++i) {
+            out.Append("  ");
+            out.Append(TextFormat::Percent(regions[i].first, taken));
+            out.Append("  tape");
+            out.AppendInt(static_cast<long long>(tape));
+            out.Append(' ');
+            out.AppendInt(regions[i].second);
+            out.Append("..");
+            out.AppendInt(regions[i].second + regionWidth[tape] - 1);
+            out.Append('\n');
+        }
+    }
+}
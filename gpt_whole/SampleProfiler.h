@@ -0,0 +1,39 @@
+#pragma once
+#include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include <string>
+#include <ctime>
+#include <signal.h>
+
+// --sample and --sample-rate: a SIGPROF timer samples the state and head
+// positions rate times a second of CPU time; Finish reports them. The state
+// name is copied while the simulation may be assigning it, so a torn copy
+// that spells another state of the same length (q12 half way to q21) is
+// counted against that state; other torn copies count as unattributed.
+class SampleProfiler {
+public:
+    SampleProfiler(const TuringMachine& tm, const MachineConfiguration& config, const std::string& foldedPath, long long rate);
+    ~SampleProfiler();
+
+    void Finish();
+
+private:
+    static void handle(int signal);
+    void stop();
+    void report() const;
+
+    const TuringMachine& tm;
+    const MachineConfiguration& config;
+    size_t tapes;
+    size_t stateWidth;
+    size_t stride;
+    std::string foldedPath;
+    long long rate;
+    char* samples = nullptr;
+    size_t capacity;
+    volatile size_t count = 0;
+    volatile size_t dropped = 0;
+    bool running = false;
+    timer_t timer;
+    struct sigaction previousAction;
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+#include "types/MachineConfiguration.h"
+
+// Hooks into MachineSimulator::Run. BeforeStep sees the configuration a
+// verbose trace prints as step; OnHalt runs before streamed input is
+// drained, OnFinish after.
+class StepObserver {
+public:
+    virtual ~StepObserver() {}
+    virtual void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) = 0;
+    virtual void OnHalt(long long steps, MachineConfiguration& config) { (void)steps; (void)config; }
+    virtual void OnFinish(long long steps, const MachineConfiguration& config) { (void)steps; (void)config; }
+};
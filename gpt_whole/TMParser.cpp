@@ -71,7 +71,9 @@ TuringMachine TMParser::Parse(const std::string& filePath) {
     TuringMachine tm;
     tm.transitions.clear();
     std::string line;
+    int lineNumber = 0;
     while (std::getline(fin, line)) {
+        ++lineNumber;
         std::string trimmed = Trim(line);
         if (trimmed.empty() || startsWith(trimmed, ";")) {
             continue;
@@ -116,6 +118,7 @@ TuringMachine TMParser::Parse(const std::string& filePath) {
             tm.tapeCount = TMParser::parseInt(trimmed);
         } else {
             Transition transition = TMParser::parseTransition(trimmed, tm.tapeCount, tm.states, tm.tapeAlphabet);
+            transition.line = lineNumber;
             tm.transitions.push_back(transition);
         }
     }
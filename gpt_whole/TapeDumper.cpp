@@ -0,0 +1,49 @@
+#include "TapeDumper.h"
+#include "OutputWriter.h"
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Writes <directory>/tape<i>.dat for every tape, creating the directory if
+// it does not exist yet.
+void TapeDumper::Dump(const MachineConfiguration& config, const std::string& directory) {
+    if (::mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST) {
+        throw std::runtime_error("cannot create " + directory);
+    }
+    std::string prefix = directory;
+    if (!prefix.empty() && prefix[prefix.size() - 1] != '/') {
+        prefix.push_back('/');
+    }
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        TapeDumper::dumpTape(config.tapes[i], static_cast<std::uint32_t>(i), prefix + "tape" + std::to_string(i) + ".dat");
+    }
+}
+
+void TapeDumper::dumpTape(const Tape& tape, std::uint32_t index, const std::string& path) {
+    TapeDumpHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "TMTAPE1", 8);
+    header.headerSize = sizeof(TapeDumpHeader);
+    header.firstPosition = tape.Empty() ? 0 : tape.left;
+    header.cellCount = tape.Empty() ? 0 : static_cast<std::uint64_t>(tape.right - tape.left + 1);
+    header.headPosition = tape.headPosition;
+    header.tapeIndex = index;
+    header.blank = tape.blank;
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<char*>(tape.cells.data() + (header.firstPosition - tape.origin));
+    iov[1].iov_len = static_cast<size_t>(header.cellCount);
+    bool written = OutputWriter::WriteAll(fd, iov, header.cellCount > 0 ? 2 : 1);
+    if (::close(fd) != 0 || !written) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
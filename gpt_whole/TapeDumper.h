@@ -0,0 +1,27 @@
+#pragma once
+#include "types/MachineConfiguration.h"
+#include <cstdint>
+#include <string>
+
+// Header of a tape dump file; the cells follow at headerSize, so the cell
+// at position p is data[p - firstPosition]. Host byte order.
+struct TapeDumpHeader {
+    char magic[8];              // "TMTAPE1\0"
+    std::uint64_t headerSize;   // offset of the first cell
+    std::int64_t firstPosition; // tape position of the first cell
+    std::uint64_t cellCount;
+    std::int64_t headPosition;
+    std::uint32_t tapeIndex;
+    char blank;
+    char reserved[19];
+};
+
+static_assert(sizeof(TapeDumpHeader) == 64, "tape dump header must stay 64 bytes");
+
+class TapeDumper {
+public:
+    static void Dump(const MachineConfiguration& config, const std::string& directory);
+
+private:
+    static void dumpTape(const Tape& tape, std::uint32_t index, const std::string& path);
+};
@@ -0,0 +1,155 @@
+#include "TapeProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Columns in the heatmap, and the shades from no visits to the most.
+    const long long HeatmapColumns = 64;
+    const char Shades[] = " .:-=+*#%@";
+    const long long VisitBins = 4096;
+
+    std::string Cells(long long count) {
+        return std::to_string(count) + (count == 1 ? " cell" : " cells");
+    }
+
+    std::string Ratio(const char* format, double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), format, value);
+        return text;
+    }
+}
+
+TapeProfiler::TapeProfiler(const TuringMachine& tm, size_t tapeCount)
+    : tm(tm), tapes(tapeCount) {
+    for (auto& use : tapes) {
+        use.bins.assign(static_cast<size_t>(VisitBins), 0);
+    }
+}
+
+// Bin b holds positions b << shift .. ((b + 1) << shift) - 1.
+void TapeProfiler::visit(TapeUse& use, long long position) {
+    if (!use.visited) {
+        use.visited = true;
+        use.firstBin = position - VisitBins / 2;
+        use.lowest = position;
+        use.highest = position;
+    }
+    long long bin = position >> use.shift;
+    if (bin < use.firstBin || bin >= use.firstBin + VisitBins) {
+        TapeProfiler::rebin(use, std::min(use.lowest, position), std::max(use.highest, position));
+        bin = position >> use.shift;
+    }
+    ++use.bins[static_cast<size_t>(bin - use.firstBin)];
+    use.lowest = std::min(use.lowest, position);
+    use.highest = std::max(use.highest, position);
+}
+
+// Widens the bins until lowest..highest fits, then centres the range.
+void TapeProfiler::rebin(TapeUse& use, long long lowest, long long highest) {
+    int shift = use.shift;
+    while ((highest >> shift) - (lowest >> shift) >= VisitBins) {
+        ++shift;
+    }
+    long long span = (highest >> shift) - (lowest >> shift) + 1;
+    long long firstBin = (lowest >> shift) - (VisitBins - span) / 2;
+    std::vector<unsigned long long> moved(use.bins.size(), 0);
+    for (long long i = 0; i < VisitBins; ++i) {
+        if (use.bins[static_cast<size_t>(i)] != 0) {
+            moved[static_cast<size_t>(((use.firstBin + i) >> (shift - use.shift)) - firstBin)] += use.bins[static_cast<size_t>(i)];
+        }
+    }
+    use.bins.swap(moved);
+    use.firstBin = firstBin;
+    use.shift = shift;
+}
+
+void TapeProfiler::BeforeStep(long long /*step*/, const MachineConfiguration& config, int transitionIndex) {
+    const Transition& t = tm.transitions[static_cast<size_t>(transitionIndex)];
+    for (size_t i = 0; i < tapes.size(); ++i) {
+        TapeUse& use = tapes[i];
+        const Tape& tape = config.tapes[i];
+        visit(use, tape.headPosition);
+        char written = t.newSymbols[i];
+        if (written != '*') {
+            ++use.writes;
+            if (written != tape.Read(tape.headPosition)) {
+                ++use.changes;
+            }
+        }
+        int move = t.directions[i] == Direction::LEFT ? -1 : (t.directions[i] == Direction::RIGHT ? 1 : 0);
+        if (move != 0) {
+            ++use.moves;
+            if (use.lastMove != 0 && move != use.lastMove) {
+                ++use.reversals;
+            }
+            use.lastMove = move;
+        }
+    }
+}
+
+// One character per column of bins, shaded by visits per cell.
+std::string TapeProfiler::heatmap(const TapeUse& use) const {
+    long long lowestBin = use.lowest >> use.shift;
+    long long bins = (use.highest >> use.shift) - lowestBin + 1;
+    long long binsPerColumn = (bins + HeatmapColumns - 1) / HeatmapColumns;
+    long long columns = (bins + binsPerColumn - 1) / binsPerColumn;
+    long long width = binsPerColumn << use.shift;
+    std::vector<double> density(static_cast<size_t>(columns), 0.0);
+    for (long long column = 0; column < columns; ++column) {
+        long long firstBin = lowestBin + column * binsPerColumn;
+        long long lastBin = std::min(firstBin + binsPerColumn, lowestBin + bins) - 1;
+        unsigned long long visits = 0;
+        for (long long bin = firstBin; bin <= lastBin; ++bin) {
+            visits += use.bins[static_cast<size_t>(bin - use.firstBin)];
+        }
+        long long first = std::max(use.lowest, firstBin << use.shift);
+        long long last = std::min(use.highest, ((lastBin + 1) << use.shift) - 1);
+        density[static_cast<size_t>(column)] = static_cast<double>(visits) / static_cast<double>(last - first + 1);
+    }
+    double busiest = *std::max_element(density.begin(), density.end());
+    const double levels = static_cast<double>(sizeof(Shades) - 2);
+    std::string line = "  |";
+    for (double value : density) {
+        line.push_back(Shades[value == 0 ? 0 : static_cast<size_t>(std::ceil(value * levels / busiest))]);
+    }
+    line += "|\n   " + std::to_string(use.lowest);
+    std::string right = std::to_string(use.highest);
+    size_t used = std::to_string(use.lowest).size() + right.size();
+    if (used < static_cast<size_t>(columns)) {
+        line.append(static_cast<size_t>(columns) - used, ' ');
+    } else {
+        line.push_back(' ');
+    }
+    line += right + "  (" + Cells(width) + " per column)\n";
+    return line;
+}
+
+void TapeProfiler::OnFinish(long long steps, const MachineConfiguration& config) {
+    std::string out;
+    out += "==================== TAPE PROFILE ====================\n";
+    out += "steps    : " + std::to_string(steps) + "\n";
+    for (size_t i = 0; i < tapes.size(); ++i) {
+        const TapeUse& use = tapes[i];
+        const Tape& tape = config.tapes[i];
+        out += "\ntape" + std::to_string(i) + "\n";
+        out += "  contents : ";
+        out += tape.Empty() ? std::string("empty") : std::to_string(tape.left) + ".." + std::to_string(tape.right) + " ("
+                                                        + Cells(tape.right - tape.left + 1) + ")";
+        out += "\n";
+        if (!use.visited) {
+            out += "  head     : no steps\n";
+            continue;
+        }
+        out += "  head     : " + std::to_string(use.lowest) + ".." + std::to_string(use.highest) + " ("
+               + Cells(use.highest - use.lowest + 1) + ")\n";
+        out += "  moves    : " + std::to_string(use.moves) + " (" + std::to_string(static_cast<unsigned long long>(steps) - use.moves)
+               + " stays)\n";
+        out += "  reversals: " + std::to_string(use.reversals) + ", average sweep "
+               + Ratio("%.1f", static_cast<double>(use.moves) / static_cast<double>(use.reversals + 1)) + " cells\n";
+        out += "  writes   : " + std::to_string(use.writes) + ", " + std::to_string(use.changes) + " changed a cell ("
+               + Ratio("%.1f%%", use.writes == 0 ? 0.0 : 100.0 * static_cast<double>(use.changes) / static_cast<double>(use.writes)) + ")\n";
+        out += heatmap(use);
+    }
+    std::fputs(out.c_str(), stderr);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "StepObserver.h"
+#include "types/TuringMachine.h"
+#include <string>
+#include <vector>
+
+// --tape-profile: head visits, range, turns, sweep lengths and writes per
+// tape. Visits are binned, widening the bins as the range grows.
+class TapeProfiler : public StepObserver {
+public:
+    TapeProfiler(const TuringMachine& tm, size_t tapeCount);
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex);
+    void OnFinish(long long steps, const MachineConfiguration& config);
+
+private:
+    struct TapeUse {
+        std::vector<unsigned long long> bins;
+        long long firstBin = 0;
+        int shift = 0;
+        bool visited = false;
+        long long lowest = 0;
+        long long highest = 0;
+        unsigned long long moves = 0;
+        unsigned long long reversals = 0;
+        unsigned long long writes = 0;
+        unsigned long long changes = 0;
+        int lastMove = 0;
+    };
+
+    static void visit(TapeUse& use, long long position);
+    static void rebin(TapeUse& use, long long lowest, long long highest);
+    std::string heatmap(const TapeUse& use) const;
+
+    const TuringMachine& tm;
+    std::vector<TapeUse> tapes;
+};
@@ -0,0 +1,35 @@
+#include "TextFormat.h"
+#include <cctype>
+#include <cstdio>
+
+bool TextFormat::ParseCount(const std::string& text, long long& value) {
+    if (text.empty() || text.size() > 18) return false;
+    for (char c : text) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) return false;
+    }
+    value = std::stoll(text);
+    return true;
+}
+
+std::string TextFormat::Percent(unsigned long long part, unsigned long long whole) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%5.1f%%", whole == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(whole));
+    return text;
+}
+
+std::string TextFormat::Padded(unsigned long long value, size_t width) {
+    std::string text = std::to_string(value);
+    return text.size() < width ? std::string(width - text.size(), ' ') + text : text;
+}
+
+std::string TextFormat::JsonString(const std::string& text) {
+    std::string out("\"");
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
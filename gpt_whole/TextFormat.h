@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Number parsing and text formatting shared by the command line, the
+// profilers and the JSON writers.
+class TextFormat {
+public:
+    // Accepts only decimal digits, at most 18 of them.
+    static bool ParseCount(const std::string& text, long long& value);
+    // "%5.1f%%" of part / whole; 0.0% when whole is 0.
+    static std::string Percent(unsigned long long part, unsigned long long whole);
+    // Right-aligned in width columns, never truncated.
+    static std::string Padded(unsigned long long value, size_t width);
+    static std::string JsonString(const std::string& text);
+};
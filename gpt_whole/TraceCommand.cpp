@@ -0,0 +1,272 @@
+#include "TraceCommand.h"
+#include "DeltaTrace.h"
+#include "ErrorHandler.h"
+#include "ResultPrinter.h"
+#include "TraceReader.h"
+#include "OutputBuffer.h"
+#include "OutputWriter.h"
+#include "TraceEvents.h"
+#include "TextFormat.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+    // Steps [first, end) of a parallel render (end < 0: up to the halt).
+    struct Segment {
+        long long first;
+        long long end;
+        OutputBuffer out;
+        bool done = false;
+        bool halted = false;
+    };
+}
+
+// argv[0] is "trace".
+int TraceCommand::Main(int argc, char* argv[]) {
+    if (argc < 2) {
+        TraceCommand::PrintHelp();
+        return 1;
+    }
+    std::string command = argv[1];
+    long long window = -1;
+    long long from = 0;
+    long long to = -1;
+    long long showStep = -1;
+    long long jobs = static_cast<long long>(std::thread::hardware_concurrency());
+    std::string traceEventsPath;
+    std::vector<std::string> filteredArgs;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--trace-window" && i + 1 < argc && TextFormat::ParseCount(argv[i + 1], window)) {
+            ++i;
+        } else if (arg == "--from" && i + 1 < argc && TextFormat::ParseCount(argv[i + 1], from)) {
+            ++i;
+        } else if (arg == "--to" && i + 1 < argc && TextFormat::ParseCount(argv[i + 1], to)) {
+            ++i;
+        } else if (arg == "--step" && i + 1 < argc && TextFormat::ParseCount(argv[i + 1], showStep)) {
+            ++i;
+        } else if (arg == "--jobs" && i + 1 < argc && TextFormat::ParseCount(argv[i + 1], jobs)) {
+            ++i;
+        } else if (arg == "--trace-events" && i + 1 < argc) {
+            traceEventsPath = argv[++i];
+        } else {
+            filteredArgs.push_back(arg);
+        }
+    }
+
+    try {
+        if (command == "expand" && filteredArgs.size() <= 1) {
+            if (filteredArgs.empty() || filteredArgs[0] == "-") {
+                DeltaTrace::Expand(std::cin, window);
+            } else {
+                std::ifstream fin(filteredArgs[0].c_str());
+                if (!fin) {
+                    ErrorHandler::Report("cannot open " + filteredArgs[0]);
+                    return 1;
+                }
+                DeltaTrace::Expand(fin, window);
+            }
+            return 0;
+        }
+        if (command == "render" && filteredArgs.size() == 1) {
+            if (!traceEventsPath.empty()) {
+#ifdef TM_TRACE_EVENTS
+                TraceEvents::Enable();
+#else
+                throw std::runtime_error("--trace-events needs a build with -DTM_TRACE_EVENTS");
+#endif
+            }
+            if (jobs > 1) {
+                TraceCommand::renderParallel(filteredArgs[0], from, to, window, static_cast<int>(jobs));
+            } else {
+                TraceCommand::render(filteredArgs[0], from, to, window);
+            }
+#ifdef TM_TRACE_EVENTS
+            if (!traceEventsPath.empty()) {
+                TraceEvents::Export(traceEventsPath);
+            }
+#endif
+            return 0;
+        }
+        if (command == "show" && filteredArgs.size() == 1 && showStep >= 0) {
+            TraceCommand::render(filteredArgs[0], showStep, showStep, window);
+            return 0;
+        }
+        if (command == "stats" && filteredArgs.size() == 1) {
+            TraceCommand::stats(filteredArgs[0]);
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        ErrorHandler::Report(e.what());
+        return 1;
+    }
+    TraceCommand::PrintHelp();
+    return 1;
+}
+
+void TraceCommand::PrintHelp() {
+    std::cerr << "usage: turing trace expand [--trace-window <k>] [<delta-trace>]" << std::endl;
+    std::cerr << "       turing trace render [--from <step>] [--to <step>] [--trace-window <k>] [--jobs <n>] [--trace-events <file>] <trace>" << std::endl;
+    std::cerr << "       turing trace show --step <n> [--trace-window <k>] <trace>" << std::endl;
+    std::cerr << "       turing trace stats <trace>" << std::endl;
+}
+
+// Prints steps from..to (to < 0: up to the halt) in the verbose format.
+void TraceCommand::render(const std::string& path, long long from, long long to, long long window) {
+    TraceReader reader(path);
+    ResultPrinter::PrintVerboseStart(reader.Input());
+    bool halted = !reader.Seek(from);
+    while (!halted && (to < 0 || reader.StepNumber() <= to)) {
+        ResultPrinter::PrintVerboseStep(reader.StepNumber(), reader.Configuration(), window);
+        halted = !reader.Advance();
+    }
+    if (halted) {
+        ResultPrinter::PrintVerboseResult(reader.Configuration());
+    } else {
+        ResultPrinter::FlushVerbose();
+    }
+}
+
+// render with jobs threads: segments start at keyframes and are written in
+// order, at most 2 jobs of them ahead of the output.
+void TraceCommand::renderParallel(const std::string& path, long long from, long long to, long long window, int jobs) {
+    TraceReader reader(path);
+    std::vector<long long> keyframes = reader.KeyframeSteps();
+    long long known = keyframes.empty() ? from : std::max(keyframes.back(), from);
+    if (to >= 0) {
+        known = std::min(known, to);
+    }
+    long long minimum = std::max(1LL, (known - from) / (8LL * jobs));
+    std::vector<std::unique_ptr<Segment> > segments;
+    segments.emplace_back(new Segment());
+    segments.back()->first = from;
+    for (long long keyframe : keyframes) {
+        if (keyframe - segments.back()->first >= minimum && (to < 0 || keyframe <= to)) {
+            segments.back()->end = keyframe;
+            segments.emplace_back(new Segment());
+            segments.back()->first = keyframe;
+        }
+    }
+    segments.back()->end = to < 0 ? -1 : to + 1;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next = 0;
+    size_t written = 0;
+    bool stop = false;
+    std::exception_ptr error;
+    auto work = [&]() {
+        TRACE_THREAD_NAME("render worker");
+        try {
+            TraceReader segmentReader(path);
+            while (true) {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() {
+                        return stop || next >= segments.size() || next < written + 2 * static_cast<size_t>(jobs);
+                    });
+                    if (stop || next >= segments.size()) {
+                        return;
+                    }
+                    index = next++;
+                }
+                Segment& segment = *segments[index];
+                TRACE_SPAN("render segment");
+                bool halted = !segmentReader.Seek(segment.first);
+                while (!halted && (segment.end < 0 || segmentReader.StepNumber() < segment.end)) {
+                    ResultPrinter::RenderVerboseStep(segment.out, segmentReader.StepNumber(), segmentReader.Configuration(), window);
+                    halted = !segmentReader.Advance();
+                }
+                if (halted) {
+                    ResultPrinter::RenderVerboseResult(segment.out, segmentReader.Configuration());
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                segment.halted = halted;
+                segment.done = true;
+                changed.notify_all();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            stop = true;
+            changed.notify_all();
+        }
+    };
+
+    ResultPrinter::PrintVerboseStart(reader.Input());
+    ResultPrinter::FlushVerbose();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < jobs; ++i) {
+        workers.emplace_back(work);
+    }
+    for (size_t i = 0; i < segments.size(); ++i) {
+        {
+            TRACE_SPAN("wait for segment");
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return segments[i]->done || error; });
+            if (error) {
+                break;
+            }
+        }
+        bool failed = !OutputWriter::WriteAll(STDOUT_FILENO, segments[i]->out.Contents());
+        bool halted = segments[i]->halted;
+        std::lock_guard<std::mutex> lock(mutex);
+        segments[i].reset();
+        written = i + 1;
+        if (failed && !error) {
+            error = std::make_exception_ptr(std::runtime_error("cannot write result"));
+        }
+        stop = stop || halted || failed;
+        changed.notify_all();
+        if (halted || failed) {
+            break;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        changed.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TraceCommand::stats(const std::string& path) {
+    TraceReader reader(path);
+    std::vector<unsigned long long> fired(reader.Transitions().size(), 0);
+    while (reader.Advance()) {
+        fired[static_cast<size_t>(reader.LastTransition())] += 1;
+    }
+    std::ifstream fin(path.c_str(), std::ios::binary | std::ios::ate);
+    long long bytes = static_cast<long long>(fin.tellg());
+    long long steps = reader.StepNumber();
+    std::cout << "steps       : " << steps << std::endl;
+    std::cout << "bytes       : " << bytes << std::endl;
+    if (steps > 0) {
+        std::cout << "bytes/step  : " << static_cast<double>(bytes) / static_cast<double>(steps) << std::endl;
+    }
+    std::cout << "loads       : " << reader.LoadCount() << std::endl;
+    std::cout << "final state : " << reader.Configuration().currentState << std::endl;
+    for (size_t i = 0; i < fired.size(); ++i) {
+        const Transition& t = reader.Transitions()[i];
+        std::cout << "transition " << i << " (" << t.oldState << " " << std::string(t.oldSymbols.begin(), t.oldSymbols.end())
+                  << " -> " << t.newState << "): " << fired[i] << std::endl;
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+
+// "turing trace <command> ..." tools that work on recorded traces.
+class TraceCommand {
+public:
+    static int Main(int argc, char* argv[]);
+    static void PrintHelp();
+
+private:
+    static void render(const std::string& path, long long from, long long to, long long window);
+    static void renderParallel(const std::string& path, long long from, long long to, long long window, int jobs);
+    static void stats(const std::string& path);
+};
@@ -0,0 +1,102 @@
+#include "TraceEvents.h"
+
+#ifdef TM_TRACE_EVENTS
+#include "TextFormat.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char* name;
+        long long nanoseconds;
+        char phase;
+    };
+
+    struct ThreadBuffer {
+        int tid;
+        const char* name = nullptr;
+        std::vector<Event> events;
+    };
+
+    std::atomic<bool> enabled{false};
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer> >& Registry() {
+        static std::vector<std::unique_ptr<ThreadBuffer> > registry;
+        return registry;
+    }
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    // The registry lock is only taken the first time a thread records.
+    ThreadBuffer& LocalBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            Registry().emplace_back(new ThreadBuffer());
+            buffer = Registry().back().get();
+            buffer->tid = static_cast<int>(Registry().size());
+            buffer->events.reserve(4096);
+        }
+        return *buffer;
+    }
+
+    long long Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+}
+
+void TraceEvents::Enable() {
+    enabled.store(true, std::memory_order_relaxed);
+    TraceEvents::NameThread("main");
+}
+
+bool TraceEvents::Enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void TraceEvents::Begin(const char* name) {
+    LocalBuffer().events.push_back(Event{name, Now(), 'B'});
+}
+
+void TraceEvents::End() {
+    LocalBuffer().events.push_back(Event{"", Now(), 'E'});
+}
+
+void TraceEvents::NameThread(const char* name) {
+    LocalBuffer().name = name;
+}
+
+// Call once every recording thread has finished.
+void TraceEvents::Export(const std::string& path) {
+    std::ofstream out(path.c_str());
+    if (!out) {
+        throw std::runtime_error("cannot write " + path);
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (const auto& buffer : Registry()) {
+        if (buffer->name) {
+            out << (first ? "\n" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " << buffer->tid
+                << ", \"args\": {\"name\": " << TextFormat::JsonString(buffer->name) << "}}";
+            first = false;
+        }
+        for (const Event& event : buffer->events) {
+            out << (first ? "\n" : ",\n") << "{\"ph\": \"" << event.phase << "\", ";
+            if (event.phase == 'B') {
+                out << "\"name\": " << TextFormat::JsonString(event.name) << ", ";
+            }
+            out << "\"pid\": 1, \"tid\": " << buffer->tid << ", \"ts\": " << event.nanoseconds / 1000 << "."
+                << static_cast<char>('0' + event.nanoseconds / 100 % 10) << static_cast<char>('0' + event.nanoseconds / 10 % 10)
+                << static_cast<char>('0' + event.nanoseconds % 10) << "}";
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+}
+
+#endif
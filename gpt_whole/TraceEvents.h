@@ -0,0 +1,61 @@
+#pragma once
+#include "StepObserver.h"
+#include <string>
+
+// Chrome trace-event timeline for --trace-events, only in builds with
+// -DTM_TRACE_EVENTS; otherwise the macros expand to nothing.
+#ifdef TM_TRACE_EVENTS
+
+class TraceEvents {
+public:
+    static void Enable();
+    static bool Enabled();
+    static void Begin(const char* name);
+    static void End();
+    static void NameThread(const char* name);
+    static void Export(const std::string& path);
+
+    class Span {
+    public:
+        explicit Span(const char* name) : active(Enabled()) {
+            if (active) Begin(name);
+        }
+        ~Span() {
+            if (active) End();
+        }
+
+    private:
+        bool active;
+    };
+};
+
+// Splits a simulation into spans of 65536 steps, so the timeline shows how
+// its speed varies over the run.
+class TraceQuanta : public StepObserver {
+public:
+    void BeforeStep(long long step, const MachineConfiguration& /*config*/, int /*transitionIndex*/) {
+        if ((step & 65535) == 0) {
+            if (step > 0) TraceEvents::End();
+            TraceEvents::Begin("simulate quantum");
+        }
+    }
+    void OnHalt(long long steps, MachineConfiguration& /*config*/) {
+        if (steps > 0) TraceEvents::End();
+    }
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SPAN(name) TraceEvents::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_BEGIN(name) do { if (TraceEvents::Enabled()) TraceEvents::Begin(name); } while (0)
+#define TRACE_END() do { if (TraceEvents::Enabled()) TraceEvents::End(); } while (0)
+#define TRACE_THREAD_NAME(name) do { if (TraceEvents::Enabled()) TraceEvents::NameThread(name); } while (0)
+
+#else
+
+#define TRACE_SPAN(name) do { } while (0)
+#define TRACE_BEGIN(name) do { } while (0)
+#define TRACE_END() do { } while (0)
+#define TRACE_THREAD_NAME(name) do { } while (0)
+
+#endif
@@ -0,0 +1,275 @@
+#include "TracePredicate.h"
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+    std::vector<std::string> Tokenize(const std::string& expression) {
+        std::vector<std::string> tokens;
+        size_t i = 0;
+        while (i < expression.size()) {
+            char c = expression[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                ++i;
+                continue;
+            }
+            std::string two = expression.substr(i, 2);
+            if (two == "&&" || two == "||" || two == "==" || two == "!=" || two == "<=" || two == ">=") {
+                tokens.push_back(two);
+                i += 2;
+                continue;
+            }
+            if (c == '(' || c == ')' || c == '!' || c == '<' || c == '>') {
+                tokens.push_back(std::string(1, c));
+                ++i;
+                continue;
+            }
+            if (c == '\'' || c == '"') {
+                size_t close = expression.find(c, i + 1);
+                if (close == std::string::npos) {
+                    throw std::runtime_error("bad trace expression: unterminated quote");
+                }
+                // The token keeps its quotes so it never reads as an operator.
+                tokens.push_back(expression.substr(i, close + 1 - i));
+                i = close + 1;
+                continue;
+            }
+            size_t start = i;
+            while (i < expression.size() && !std::isspace(static_cast<unsigned char>(expression[i]))
+                   && std::string("()!<>=&|'\"").find(expression[i]) == std::string::npos) {
+                ++i;
+            }
+            if (i == start) {
+                throw std::runtime_error("bad trace expression");
+            }
+            tokens.push_back(expression.substr(start, i - start));
+        }
+        return tokens;
+    }
+
+    std::string Unquote(const std::string& token) {
+        if (token.size() >= 2 && (token[0] == '\'' || token[0] == '"')) {
+            return token.substr(1, token.size() - 2);
+        }
+        return token;
+    }
+
+    // "head12" -> 12 for field "head"; false if name is not field<digits>.
+    bool TapeField(const std::string& name, const std::string& field, size_t& tape) {
+        if (name.size() <= field.size() || name.compare(0, field.size(), field) != 0) {
+            return false;
+        }
+        tape = 0;
+        for (size_t i = field.size(); i < name.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(name[i])) || i - field.size() > 6) {
+                return false;
+            }
+            tape = tape * 10 + static_cast<size_t>(name[i] - '0');
+        }
+        return true;
+    }
+
+    bool ParseNumber(const std::string& text, long long& value) {
+        size_t start = (!text.empty() && text[0] == '-') ? 1 : 0;
+        if (text.size() == start || text.size() - start > 18) {
+            return false;
+        }
+        for (size_t i = start; i < text.size(); ++i) {
+            if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+                return false;
+            }
+        }
+        value = std::stoll(text);
+        return true;
+    }
+}
+
+TracePredicate::TracePredicate(const TuringMachine& tm, const std::string& expression, long long every)
+    : tm(tm), every(every), verdicts(tm.transitions.size(), Verdict::ALWAYS) {
+    if (expression.empty()) {
+        return;
+    }
+    std::vector<std::string> tokens = Tokenize(expression);
+    size_t pos = 0;
+    root = parseOr(tokens, pos);
+    if (pos != tokens.size()) {
+        throw std::runtime_error("bad trace expression");
+    }
+    for (size_t i = 0; i < tm.transitions.size(); ++i) {
+        int value = evaluate(root, 0, nullptr, static_cast<int>(i));
+        verdicts[i] = value == kTrue ? Verdict::ALWAYS : (value == kFalse ? Verdict::NEVER : Verdict::CHECK);
+    }
+    haltVerdict = Verdict::CHECK;
+}
+
+int TracePredicate::parseOr(const std::vector<std::string>& tokens, size_t& pos) {
+    int left = parseAnd(tokens, pos);
+    while (pos < tokens.size() && tokens[pos] == "||") {
+        ++pos;
+        Node node;
+        node.kind = NodeKind::OR;
+        node.left = left;
+        node.right = parseAnd(tokens, pos);
+        nodes.push_back(node);
+        left = static_cast<int>(nodes.size()) - 1;
+    }
+    return left;
+}
+
+int TracePredicate::parseAnd(const std::vector<std::string>& tokens, size_t& pos) {
+    int left = parseUnary(tokens, pos);
+    while (pos < tokens.size() && tokens[pos] == "&&") {
+        ++pos;
+        Node node;
+        node.kind = NodeKind::AND;
+        node.left = left;
+        node.right = parseUnary(tokens, pos);
+        nodes.push_back(node);
+        left = static_cast<int>(nodes.size()) - 1;
+    }
+    return left;
+}
+
+int TracePredicate::parseUnary(const std::vector<std::string>& tokens, size_t& pos) {
+    if (pos < tokens.size() && tokens[pos] == "!") {
+        ++pos;
+        Node node;
+        node.kind = NodeKind::NOT;
+        node.left = parseUnary(tokens, pos);
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    if (pos < tokens.size() && tokens[pos] == "(") {
+        ++pos;
+        int inner = parseOr(tokens, pos);
+        if (pos >= tokens.size() || tokens[pos] != ")") {
+            throw std::runtime_error("bad trace expression");
+        }
+        ++pos;
+        return inner;
+    }
+    return parseComparison(tokens, pos);
+}
+
+int TracePredicate::parseComparison(const std::vector<std::string>& tokens, size_t& pos) {
+    if (pos + 3 > tokens.size()) {
+        throw std::runtime_error("bad trace expression");
+    }
+    const std::string& name = tokens[pos];
+    const std::string& op = tokens[pos + 1];
+    std::string value = Unquote(tokens[pos + 2]);
+    pos += 3;
+
+    Node node;
+    if (op == "==") node.compare = Compare::EQ;
+    else if (op == "!=") node.compare = Compare::NE;
+    else if (op == "<") node.compare = Compare::LT;
+    else if (op == "<=") node.compare = Compare::LE;
+    else if (op == ">") node.compare = Compare::GT;
+    else if (op == ">=") node.compare = Compare::GE;
+    else throw std::runtime_error("bad trace expression");
+
+    bool numeric = true;
+    if (name == "state") {
+        node.kind = NodeKind::STATE;
+        node.text = value;
+        numeric = false;
+    } else if (name == "step") {
+        node.kind = NodeKind::STEP;
+    } else if (TapeField(name, "sym", node.tape)) {
+        node.kind = NodeKind::SYMBOL;
+        numeric = false;
+    } else if (TapeField(name, "write", node.tape)) {
+        node.kind = NodeKind::WRITE;
+        numeric = false;
+    } else if (TapeField(name, "head", node.tape)) {
+        node.kind = NodeKind::HEAD;
+    } else {
+        throw std::runtime_error("bad trace expression: unknown field " + name);
+    }
+    if (node.kind != NodeKind::STATE && node.kind != NodeKind::STEP && node.tape >= static_cast<size_t>(tm.tapeCount)) {
+        throw std::runtime_error("bad trace expression: no tape " + name);
+    }
+    if (numeric) {
+        if (!ParseNumber(value, node.number)) {
+            throw std::runtime_error("bad trace expression: " + value + " is not a number");
+        }
+    } else {
+        if (node.compare != Compare::EQ && node.compare != Compare::NE) {
+            throw std::runtime_error("bad trace expression: " + name + " only supports == and !=");
+        }
+        if (node.kind != NodeKind::STATE) {
+            if (value.size() != 1) {
+                throw std::runtime_error("bad trace expression: " + value + " is not a symbol");
+            }
+            node.number = static_cast<unsigned char>(value[0]);
+        }
+    }
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+bool TracePredicate::compare(Compare op, long long a, long long b) {
+    switch (op) {
+        case Compare::EQ: return a == b;
+        case Compare::NE: return a != b;
+        case Compare::LT: return a < b;
+        case Compare::LE: return a <= b;
+        case Compare::GT: return a > b;
+        case Compare::GE: return a >= b;
+    }
+    return false;
+}
+
+// With config == nullptr whatever the transition does not fix is kUnknown.
+int TracePredicate::evaluate(int index, long long step, const MachineConfiguration* config, int transitionIndex) const {
+    const Node& node = nodes[static_cast<size_t>(index)];
+    const Transition* transition = transitionIndex < 0 ? nullptr : &tm.transitions[static_cast<size_t>(transitionIndex)];
+    switch (node.kind) {
+        case NodeKind::AND: {
+            int left = evaluate(node.left, step, config, transitionIndex);
+            if (left == kFalse) return kFalse;
+            int right = evaluate(node.right, step, config, transitionIndex);
+            if (right == kFalse) return kFalse;
+            return (left == kTrue && right == kTrue) ? kTrue : kUnknown;
+        }
+        case NodeKind::OR: {
+            int left = evaluate(node.left, step, config, transitionIndex);
+            if (left == kTrue) return kTrue;
+            int right = evaluate(node.right, step, config, transitionIndex);
+            if (right == kTrue) return kTrue;
+            return (left == kFalse && right == kFalse) ? kFalse : kUnknown;
+        }
+        case NodeKind::NOT: {
+            int inner = evaluate(node.left, step, config, transitionIndex);
+            return inner == kUnknown ? kUnknown : (inner == kTrue ? kFalse : kTrue);
+        }
+        case NodeKind::STATE: {
+            const std::string* state = transition ? &transition->oldState : (config ? &config->currentState : nullptr);
+            if (!state) return kUnknown;
+            return ((*state == node.text) == (node.compare == Compare::EQ)) ? kTrue : kFalse;
+        }
+        case NodeKind::SYMBOL:
+        case NodeKind::WRITE: {
+            if (node.kind == NodeKind::WRITE && !transition) {
+                return config ? kFalse : kUnknown;
+            }
+            char symbol = '*';
+            if (transition) {
+                symbol = node.kind == NodeKind::WRITE ? transition->newSymbols[node.tape] : transition->oldSymbols[node.tape];
+            }
+            if (symbol == '*') {
+                if (!config) return kUnknown;
+                const Tape& tape = config->tapes[node.tape];
+                symbol = tape.Read(tape.headPosition);
+            }
+            return compare(node.compare, static_cast<unsigned char>(symbol), node.number) ? kTrue : kFalse;
+        }
+        case NodeKind::HEAD:
+            if (!config) return kUnknown;
+            return compare(node.compare, config->tapes[node.tape].headPosition, node.number) ? kTrue : kFalse;
+        case NodeKind::STEP:
+            if (!config) return kUnknown;
+            return compare(node.compare, step, node.number) ? kTrue : kFalse;
+    }
+    return kUnknown;
+}
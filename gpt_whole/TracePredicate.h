@@ -0,0 +1,79 @@
+#pragma once
+#include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include <string>
+#include <vector>
+
+// --trace-when expression: comparisons on state, symN, writeN, headN and
+// step, combined with &&, || and ! and parentheses. Values may be quoted.
+class TracePredicate {
+public:
+    TracePredicate(const TuringMachine& tm, const std::string& expression, long long every);
+
+    // transitionIndex is the transition about to fire, or -1 at the halt.
+    bool Matches(long long step, const MachineConfiguration& config, int transitionIndex) const {
+        if (every > 0 && step % every != 0) {
+            return false;
+        }
+        Verdict verdict = transitionIndex < 0 ? haltVerdict : verdicts[static_cast<size_t>(transitionIndex)];
+        if (verdict != Verdict::CHECK) {
+            return verdict == Verdict::ALWAYS;
+        }
+        return evaluate(root, step, &config, transitionIndex) == kTrue;
+    }
+
+private:
+    enum class Verdict : char {
+        NEVER,
+        ALWAYS,
+        CHECK
+    };
+
+    enum class NodeKind {
+        AND,
+        OR,
+        NOT,
+        STATE,
+        SYMBOL,
+        WRITE,
+        HEAD,
+        STEP
+    };
+
+    enum class Compare {
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE
+    };
+
+    struct Node {
+        NodeKind kind;
+        Compare compare = Compare::EQ;
+        size_t tape = 0;
+        long long number = 0;
+        std::string text;
+        int left = -1;
+        int right = -1;
+    };
+
+    static const int kFalse = 0;
+    static const int kTrue = 1;
+    static const int kUnknown = 2;
+
+    int parseOr(const std::vector<std::string>& tokens, size_t& pos);
+    int parseAnd(const std::vector<std::string>& tokens, size_t& pos);
+    int parseUnary(const std::vector<std::string>& tokens, size_t& pos);
+    int parseComparison(const std::vector<std::string>& tokens, size_t& pos);
+    int evaluate(int node, long long step, const MachineConfiguration* config, int transitionIndex) const;
+    static bool compare(Compare op, long long a, long long b);
+
+    const TuringMachine& tm;
+    std::vector<Node> nodes;
+    int root = -1;
+    long long every;
+    std::vector<Verdict> verdicts;
+    Verdict haltVerdict = Verdict::ALWAYS;
+};
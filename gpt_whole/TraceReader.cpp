@@ -0,0 +1,160 @@
+#include "TraceReader.h"
+#include "BinaryTrace.h"
+#include "MachineSimulator.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    Direction ToDirection(char symbol) {
+        if (symbol == 'l') return Direction::LEFT;
+        if (symbol == 'r') return Direction::RIGHT;
+        if (symbol == '*') return Direction::STAY;
+        throw std::runtime_error("corrupt trace");
+    }
+}
+
+TraceReader::TraceReader(const std::string& path) : file(path.c_str(), std::ios::binary), in(file.rdbuf()) {
+    if (!file) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    char magic[8];
+    if (in->sgetn(magic, 8) != 8 || std::memcmp(magic, BinaryTrace::kMagic, 8) != 0) {
+        throw std::runtime_error("not a binary trace: " + path);
+    }
+    input = BinaryTrace::ReadString(*in);
+    blank = BinaryTrace::ReadByte(*in);
+    size_t tapeCount = static_cast<size_t>(BinaryTrace::ReadVarint(*in));
+    size_t transitionCount = static_cast<size_t>(BinaryTrace::ReadVarint(*in));
+    transitions.resize(transitionCount);
+    for (auto& t : transitions) {
+        t.oldState = BinaryTrace::ReadString(*in);
+        t.newState = BinaryTrace::ReadString(*in);
+        for (size_t i = 0; i < tapeCount; ++i) t.oldSymbols.push_back(BinaryTrace::ReadByte(*in));
+        for (size_t i = 0; i < tapeCount; ++i) t.newSymbols.push_back(BinaryTrace::ReadByte(*in));
+        for (size_t i = 0; i < tapeCount; ++i) t.directions.push_back(ToDirection(BinaryTrace::ReadByte(*in)));
+    }
+    config.currentState = BinaryTrace::ReadString(*in);
+    for (size_t i = 0; i < tapeCount; ++i) {
+        config.tapes.push_back(BinaryTrace::ReadTape(*in, blank));
+    }
+    readPending();
+    applyLoads();
+}
+
+bool TraceReader::Advance() {
+    if (pending > 0) {
+        if (pending > transitions.size()) {
+            throw std::runtime_error("corrupt trace");
+        }
+        lastTransition = static_cast<int>(pending - 1);
+        MachineSimulator::applyTransition(config, transitions[static_cast<size_t>(lastTransition)], blank);
+        step = step + 1;
+        readPending();
+        applyLoads();
+        return true;
+    }
+    if (pendingKind == BinaryTrace::kHalt) {
+        readPending();
+        applyLoads();
+    }
+    if (pendingKind != BinaryTrace::kEnd) {
+        throw std::runtime_error("corrupt trace");
+    }
+    return false;
+}
+
+// Reads the next record header into pending/pendingKind.
+void TraceReader::readPending() {
+    pending = BinaryTrace::ReadVarint(*in);
+    pendingKind = pending == 0 ? BinaryTrace::ReadByte(*in) : 0;
+}
+
+// Consumes the load and keyframe records that follow a step.
+void TraceReader::applyLoads() {
+    while (pending == 0 && (pendingKind == BinaryTrace::kLoad || pendingKind == BinaryTrace::kKeyframe)) {
+        if (pendingKind == BinaryTrace::kKeyframe) {
+            readKeyframe();
+            readPending();
+            continue;
+        }
+        size_t tapeIndex = static_cast<size_t>(BinaryTrace::ReadVarint(*in));
+        long long first = BinaryTrace::ReadSigned(*in);
+        unsigned long long count = BinaryTrace::ReadVarint(*in);
+        if (tapeIndex >= config.tapes.size()) {
+            throw std::runtime_error("corrupt trace");
+        }
+        BinaryTrace::ReadCells(*in, config.tapes[tapeIndex], first, count);
+        loads = loads + 1;
+        readPending();
+    }
+}
+
+
+void TraceReader::readKeyframe() {
+    step = static_cast<long long>(BinaryTrace::ReadVarint(*in));
+    config.currentState = BinaryTrace::ReadString(*in);
+    for (auto& tape : config.tapes) {
+        tape = BinaryTrace::ReadTape(*in, blank);
+    }
+}
+
+bool TraceReader::Seek(long long target) {
+    loadIndex();
+    size_t best = keyframes.size();
+    for (size_t i = 0; i < keyframes.size() && keyframes[i].first <= target; ++i) {
+        best = i;
+    }
+    if (best < keyframes.size() && (keyframes[best].first > step || target < step)) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(keyframes[best].second));
+        lastTransition = -1;
+        readPending();
+        if (pending != 0 || pendingKind != BinaryTrace::kKeyframe) {
+            throw std::runtime_error("corrupt trace index");
+        }
+        applyLoads();
+    }
+    if (target < step) {
+        throw std::runtime_error("cannot seek backwards");
+    }
+    while (step < target) {
+        if (!Advance()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<long long> TraceReader::KeyframeSteps() {
+    loadIndex();
+    std::vector<long long> steps;
+    for (const auto& keyframe : keyframes) {
+        steps.push_back(keyframe.first);
+    }
+    return steps;
+}
+
+// Reads the footer index once; a trace cut short has none.
+void TraceReader::loadIndex() {
+    if (indexLoaded) {
+        return;
+    }
+    indexLoaded = true;
+    std::streampos current = file.tellg();
+    file.seekg(-16, std::ios::end);
+    char magic[8];
+    if (file) {
+        unsigned long long footerOffset = BinaryTrace::ReadFixed(*in);
+        if (in->sgetn(magic, 8) == 8 && std::memcmp(magic, BinaryTrace::kIndexMagic, 8) == 0) {
+            file.seekg(static_cast<std::streamoff>(footerOffset));
+            unsigned long long count = BinaryTrace::ReadFixed(*in);
+            for (unsigned long long i = 0; i < count; ++i) {
+                long long keyframeStep = static_cast<long long>(BinaryTrace::ReadFixed(*in));
+                unsigned long long offset = BinaryTrace::ReadFixed(*in);
+                keyframes.push_back(std::make_pair(keyframeStep, offset));
+            }
+        }
+    }
+    file.clear();
+    file.seekg(current);
+}
\ No newline at end of file
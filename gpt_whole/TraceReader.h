@@ -0,0 +1,48 @@
+#pragma once
+#include "types/Transition.h"
+#include "types/MachineConfiguration.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Replays a binary trace (see BinaryTrace.h) step by step from step 0.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+
+    const std::string& Input() const { return input; }
+    const std::vector<Transition>& Transitions() const { return transitions; }
+    const MachineConfiguration& Configuration() const { return config; }
+    long long StepNumber() const { return step; }
+    int LastTransition() const { return lastTransition; }
+    unsigned long long LoadCount() const { return loads; }
+
+    // Returns false once the machine has halted.
+    bool Advance();
+
+    // Returns false if the run halted before the step.
+    bool Seek(long long target);
+
+    // Steps that have a keyframe, from the footer index.
+    std::vector<long long> KeyframeSteps();
+
+private:
+    void readPending();
+    void applyLoads();
+    void readKeyframe();
+    void loadIndex();
+
+    std::ifstream file;
+    std::streambuf* in;
+    std::string input;
+    char blank;
+    std::vector<Transition> transitions;
+    MachineConfiguration config;
+    long long step = 0;
+    int lastTransition = -1;
+    unsigned long long loads = 0;
+    unsigned long long pending = 0;
+    char pendingKind = 0;
+    bool indexLoaded = false;
+    std::vector<std::pair<long long, unsigned long long> > keyframes;
+};
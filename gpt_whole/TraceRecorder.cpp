@@ -0,0 +1,139 @@
+#include "TraceRecorder.h"
+#include "BinaryTrace.h"
+#include "InputStreamer.h"
+#include "OutputWriter.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    int OpenTrace(const std::string& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0) {
+            throw std::runtime_error("cannot write " + path);
+        }
+        return fd;
+    }
+
+    char DirectionSymbol(Direction direction) {
+        if (direction == Direction::LEFT) return 'l';
+        if (direction == Direction::RIGHT) return 'r';
+        return '*';
+    }
+}
+
+TraceRecorder::TraceRecorder(const std::string& path, const TuringMachine& tm, const std::string& input, const MachineConfiguration& config, long long keyframeInterval)
+    : fd(OpenTrace(path)), out(fd), loadedEnd(config.tapes.size(), 0),
+      keyframeInterval(keyframeInterval < 0 ? (1LL << 20) : keyframeInterval) {
+    out.Append(BinaryTrace::kMagic, 8);
+    BinaryTrace::AppendString(out, input);
+    out.Append(tm.blankSymbol);
+    BinaryTrace::AppendVarint(out, config.tapes.size());
+    BinaryTrace::AppendVarint(out, tm.transitions.size());
+    for (const auto& t : tm.transitions) {
+        BinaryTrace::AppendString(out, t.oldState);
+        BinaryTrace::AppendString(out, t.newState);
+        out.Append(t.oldSymbols.data(), t.oldSymbols.size());
+        out.Append(t.newSymbols.data(), t.newSymbols.size());
+        for (Direction direction : t.directions) {
+            out.Append(DirectionSymbol(direction));
+        }
+    }
+    BinaryTrace::AppendString(out, config.currentState);
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        BinaryTrace::AppendTape(out, config.tapes[i]);
+    }
+}
+
+TraceRecorder::~TraceRecorder() {
+    out.Flush();
+    ::close(fd);
+}
+
+void TraceRecorder::RecordStep(int transitionIndex) {
+    BinaryTrace::AppendVarint(out, static_cast<unsigned long long>(transitionIndex) + 1);
+    out.MaybeFlush();
+}
+
+// Records the streamed cells in [first, end).
+void TraceRecorder::RecordLoad(size_t tapeIndex, const Tape& tape, long long first, long long end) {
+    unsigned long long count = static_cast<unsigned long long>(end - first);
+    out.Append('\0');
+    out.Append(BinaryTrace::kLoad);
+    BinaryTrace::AppendVarint(out, tapeIndex);
+    BinaryTrace::AppendSigned(out, first);
+    BinaryTrace::AppendVarint(out, count);
+    out.Append(tape.cells.data() + (first - tape.origin), static_cast<size_t>(count));
+    out.MaybeFlush();
+}
+
+void TraceRecorder::RecordKeyframe(long long step, const MachineConfiguration& config) {
+    keyframes.push_back(std::make_pair(step, out.Offset()));
+    out.Append('\0');
+    out.Append(BinaryTrace::kKeyframe);
+    BinaryTrace::AppendVarint(out, static_cast<unsigned long long>(step));
+    BinaryTrace::AppendString(out, config.currentState);
+    for (const auto& tape : config.tapes) {
+        BinaryTrace::AppendTape(out, tape);
+    }
+    out.MaybeFlush();
+}
+
+void TraceRecorder::RecordHalt() {
+    out.Append('\0');
+    out.Append(BinaryTrace::kHalt);
+}
+
+void TraceRecorder::RecordEnd(long long steps) {
+    out.Append('\0');
+    out.Append(BinaryTrace::kEnd);
+    BinaryTrace::AppendVarint(out, static_cast<unsigned long long>(steps));
+    unsigned long long footerOffset = out.Offset();
+    std::string footer;
+    OutputWriter::AppendUint(footer, keyframes.size(), 8);
+    for (const auto& keyframe : keyframes) {
+        OutputWriter::AppendUint(footer, static_cast<unsigned long long>(keyframe.first), 8);
+        OutputWriter::AppendUint(footer, keyframe.second, 8);
+    }
+    OutputWriter::AppendUint(footer, footerOffset, 8);
+    footer.append(BinaryTrace::kIndexMagic, 8);
+    out.Append(footer);
+    out.Flush();
+}
+
+void TraceRecorder::recordLoads(const MachineConfiguration& config) {
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        const Tape& tape = config.tapes[i];
+        if (tape.source && tape.source->LoadedEnd() != loadedEnd[i]) {
+            RecordLoad(i, tape, loadedEnd[i], tape.source->LoadedEnd());
+            loadedEnd[i] = tape.source->LoadedEnd();
+        }
+    }
+}
+
+void TraceRecorder::BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) {
+    recordLoads(config);
+    if (step == 0 || (keyframeInterval > 0 && step % keyframeInterval == 0)) {
+        RecordKeyframe(step, config);
+    }
+    RecordStep(transitionIndex);
+}
+
+// Drains streamed input here so the drained cells are recorded as loads.
+void TraceRecorder::OnHalt(long long steps, MachineConfiguration& config) {
+    recordLoads(config);
+    if (steps == 0) {
+        RecordKeyframe(0, config);
+    }
+    RecordHalt();
+    for (auto& tape : config.tapes) {
+        if (tape.source) {
+            tape.source->Drain(tape);
+        }
+    }
+    recordLoads(config);
+}
+
+void TraceRecorder::OnFinish(long long steps, const MachineConfiguration& /*config*/) {
+    RecordEnd(steps);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "OutputBuffer.h"
+#include "StepObserver.h"
+#include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include <string>
+#include <vector>
+
+// --trace-bin: writes the trace described in BinaryTrace.h.
+class TraceRecorder : public StepObserver {
+public:
+    TraceRecorder(const std::string& path, const TuringMachine& tm, const std::string& input, const MachineConfiguration& config, long long keyframeInterval);
+    ~TraceRecorder();
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex);
+    void OnHalt(long long steps, MachineConfiguration& config);
+    void OnFinish(long long steps, const MachineConfiguration& config);
+
+    void RecordStep(int transitionIndex);
+    void RecordLoad(size_t tapeIndex, const Tape& tape, long long first, long long end);
+    void RecordKeyframe(long long step, const MachineConfiguration& config);
+    void RecordHalt();
+    void RecordEnd(long long steps);
+
+private:
+    void recordLoads(const MachineConfiguration& config);
+
+    int fd;
+    OutputBuffer out;
+    std::vector<long long> loadedEnd;
+    long long keyframeInterval;
+    std::vector<std::pair<long long, unsigned long long> > keyframes;
+};
@@ -1,29 +1,112 @@
 #include "VerboseTracer.h"
 #include "ResultPrinter.h"
 #include "MachineSimulator.h"
+#include "DeltaTrace.h"
+#include "VerboseWriter.h"
+#include "AllocationCounter.h"
+#include "TraceEvents.h"
 #include <iostream>
+#include <memory>
 
-void VerboseTracer::SimulateAndTrace(const TuringMachine& tm, const std::string& input) {
-    ResultPrinter::PrintVerboseStart(input);
-    MachineConfiguration config = MachineSimulator::initializeConfiguration(tm, input);
-    int step = 0;
-    while (true) {
-        ResultPrinter::PrintVerboseStep(step, config);
-        bool matched = false;
-        for (const auto& transition : tm.transitions) {
-            if (transition.oldState != config.currentState) {
-                continue;
+namespace {
+    // --trace=delta: a keyframe every keyframeInterval steps or after a
+    // filtered gap, a D line for every other step.
+    class DeltaWriter : public StepObserver {
+    public:
+        DeltaWriter(const TuringMachine& tm, size_t tapeCount, long long keyframeInterval, const TracePredicate* filter)
+            : tm(tm), keyframeInterval(keyframeInterval), filter(filter), previousHeads(tapeCount) {
+        }
+
+        void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) override {
+            if (filter && !filter->Matches(step, config, transitionIndex)) {
+                return;
             }
-            if (MachineSimulator::matchSymbols(config, transition.oldSymbols, tm.blankSymbol)) {
-                MachineSimulator::applyTransition(config, transition, tm.blankSymbol);
-                matched = true;
-                break;
+            write(step, config);
+            previous = transitionIndex;
+            for (size_t i = 0; i < config.tapes.size(); ++i) {
+                previousHeads[i] = config.tapes[i].headPosition;
             }
         }
-        if (!matched) {
-            break;
+
+        void OnHalt(long long steps, MachineConfiguration& config) override {
+            if (!filter || filter->Matches(steps, config, -1)) {
+                write(steps, config);
+            }
         }
-        step = step + 1;
+
+        void OnFinish(long long steps, const MachineConfiguration& config) override {
+            (void)steps;
+            DeltaTrace::WriteEnd(config);
+        }
+
+    private:
+        void write(long long step, const MachineConfiguration& config) {
+            if (step != written + 1 || (keyframeInterval > 0 && step % keyframeInterval == 0)) {
+                DeltaTrace::WriteKeyframe(step, config);
+            } else {
+                DeltaTrace::WriteDelta(step, tm.transitions[static_cast<size_t>(previous)], previousHeads, config);
+            }
+            written = step;
+        }
+
+        const TuringMachine& tm;
+        long long keyframeInterval;
+        const TracePredicate* filter;
+        long long written = -1;
+        int previous = -1;
+        std::vector<long long> previousHeads;
+    };
+
+    // The trace writer runs in front of the observers, and like them inside
+    // the allocation guard when there is one.
+    std::vector<StepObserver*> Chain(StepObserver* writer, const std::vector<StepObserver*>& observers, const MachineConfiguration& config, const RunOptions& options, std::unique_ptr<AllocationGuard>& guard) {
+        std::vector<StepObserver*> all(1, writer);
+        all.insert(all.end(), observers.begin(), observers.end());
+        if (options.assertNoAlloc) {
+            guard.reset(new AllocationGuard(config, all));
+            all.assign(1, guard.get());
+        }
+        return all;
+    }
+}
+
+void VerboseTracer::SimulateAndTrace(const TuringMachine& tm, const std::string& input) {
+    MachineConfiguration config = MachineSimulator::initializeConfiguration(tm, input);
+    VerboseTracer::Trace(tm, input, config, RunOptions(), std::vector<StepObserver*>());
+}
+
+// Returns the number of steps executed.
+long long VerboseTracer::Trace(const TuringMachine& tm, const std::string& input, MachineConfiguration& config, const RunOptions& options, const std::vector<StepObserver*>& observers) {
+    std::unique_ptr<TracePredicate> filter;
+    if (!options.traceWhen.empty() || options.traceEvery > 0) {
+        TRACE_SPAN("compile trace filter");
+        filter.reset(new TracePredicate(tm, options.traceWhen, options.traceEvery));
+    }
+    if (options.traceMode == TraceMode::DELTA) {
+        return VerboseTracer::traceDelta(tm, input, config, options, filter.get(), observers);
+    }
+    ResultPrinter::PrintVerboseStart(input);
+    VerboseWriter writer(tm, config, options.traceWindow, filter.get());
+    std::unique_ptr<AllocationGuard> guard;
+    std::vector<StepObserver*> all = Chain(&writer, observers, config, options, guard);
+    try {
+        return MachineSimulator::Run(tm, config, all);
+    } catch (...) {
+        writer.Abort();
+        throw;
+    }
+}
+
+long long VerboseTracer::traceDelta(const TuringMachine& tm, const std::string& input, MachineConfiguration& config, const RunOptions& options, const TracePredicate* filter, const std::vector<StepObserver*>& observers) {
+    long long keyframeInterval = options.keyframeInterval < 0 ? 1000 : options.keyframeInterval;
+    DeltaTrace::WriteStart(input);
+    DeltaWriter writer(tm, config.tapes.size(), keyframeInterval, filter);
+    std::unique_ptr<AllocationGuard> guard;
+    std::vector<StepObserver*> all = Chain(&writer, observers, config, options, guard);
+    try {
+        return MachineSimulator::Run(tm, config, all);
+    } catch (...) {
+        DeltaTrace::Flush();
+        throw;
     }
-    ResultPrinter::PrintVerboseResult(config);
 }
\ No newline at end of file
@@ -1,7 +1,16 @@
 #pragma once
 #include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include "types/RunOptions.h"
+#include "StepObserver.h"
+#include "TracePredicate.h"
+#include <vector>
 
 class VerboseTracer {
 public:
     static void SimulateAndTrace(const TuringMachine& tm, const std::string& input);
+    static long long Trace(const TuringMachine& tm, const std::string& input, MachineConfiguration& config, const RunOptions& options, const std::vector<StepObserver*>& observers);
+
+private:
+    static long long traceDelta(const TuringMachine& tm, const std::string& input, MachineConfiguration& config, const RunOptions& options, const TracePredicate* filter, const std::vector<StepObserver*>& observers);
 };
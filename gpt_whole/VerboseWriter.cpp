@@ -0,0 +1,245 @@
+#include "VerboseWriter.h"
+#include "MachineSimulator.h"
+#include "ResultPrinter.h"
+#include "InputStreamer.h"
+#include "TraceEvents.h"
+#include <algorithm>
+
+namespace {
+    const size_t kQueueCapacity = 1 << 14;
+    const size_t kWakeBatch = 256;
+    const size_t kSnapshotBudget = 64 << 20;
+
+    // The part of tape a step with the given window renders, or all of it.
+    Tape CopyTape(const Tape& tape, long long window) {
+        Tape copy;
+        copy.blank = tape.blank;
+        copy.headPosition = tape.headPosition;
+        copy.left = tape.left;
+        copy.right = tape.right;
+        if (tape.Empty()) {
+            return copy;
+        }
+        long long first = tape.left;
+        long long last = tape.right;
+        if (window >= 0) {
+            first = std::max(first, tape.headPosition - window);
+            last = std::min(last, tape.headPosition + window);
+        }
+        if (first <= last) {
+            copy.origin = first;
+            copy.cells.assign(tape.cells.begin() + (first - tape.origin), tape.cells.begin() + (last - tape.origin + 1));
+        }
+        return copy;
+    }
+}
+
+VerboseWriter::VerboseWriter(const TuringMachine& tm, const MachineConfiguration& config, long long window, const TracePredicate* filter)
+    : tm(tm), replica(config), window(window), filter(filter), loadedEnd(config.tapes.size()), queue(kQueueCapacity) {
+    for (size_t i = 0; i < replica.tapes.size(); ++i) {
+        Tape& tape = replica.tapes[i];
+        if (tape.source) {
+            loadedEnd[i] = tape.source->LoadedEnd();
+            tape.source.reset();
+        }
+    }
+    writer = std::thread(&VerboseWriter::run, this);
+}
+
+VerboseWriter::~VerboseWriter() {
+    Abort();
+}
+
+void VerboseWriter::BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex) {
+    if (filter && !filter->Matches(step, config, transitionIndex)) {
+        return;
+    }
+    catchUp(step, config, false);
+    Record record;
+    record.transitionIndex = transitionIndex;
+    record.step = step;
+    push(record);
+    replicaStep = step + 1;
+}
+
+// Drains streamed input here so the replica gets it for the result line.
+void VerboseWriter::OnHalt(long long steps, MachineConfiguration& config) {
+    if (!filter || filter->Matches(steps, config, -1)) {
+        catchUp(steps, config, false);
+        Record record;
+        record.kind = RecordKind::HALT;
+        record.step = steps;
+        push(record);
+    }
+    for (auto& tape : config.tapes) {
+        if (tape.source) {
+            tape.source->Drain(tape);
+        }
+    }
+    catchUp(steps, config, true);
+}
+
+void VerboseWriter::OnFinish(long long /*steps*/, const MachineConfiguration& /*config*/) {
+    Record record;
+    record.kind = RecordKind::END;
+    push(record);
+    writer.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Syncs the replica to step, by a snapshot if it fell behind.
+void VerboseWriter::catchUp(long long step, const MachineConfiguration& config, bool whole) {
+    if (step == replicaStep && replicaWhole) {
+        sync(config);
+        return;
+    }
+    long long cut = whole ? -1 : window;
+    Record record;
+    record.kind = RecordKind::SNAPSHOT;
+    record.snapshot.currentState = config.currentState;
+    record.snapshot.tapes.reserve(config.tapes.size());
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        const Tape& tape = config.tapes[i];
+        record.snapshot.tapes.push_back(CopyTape(tape, cut));
+        snapshotBytes += record.snapshot.tapes.back().cells.size();
+        if (tape.source) {
+            loadedEnd[i] = tape.source->LoadedEnd();
+        }
+    }
+    push(record);
+    replicaStep = step;
+    replicaWhole = cut < 0;
+    if (snapshotBytes > kSnapshotBudget) {
+        waitUntilDrained();
+        snapshotBytes = 0;
+    }
+}
+
+// Forwards cells streamed into config since the last call.
+void VerboseWriter::sync(const MachineConfiguration& config) {
+    for (size_t i = 0; i < config.tapes.size(); ++i) {
+        const Tape& tape = config.tapes[i];
+        if (tape.source && tape.source->LoadedEnd() != loadedEnd[i]) {
+            long long end = tape.source->LoadedEnd();
+            Record record;
+            record.kind = RecordKind::LOAD;
+            record.tapeIndex = i;
+            record.first = loadedEnd[i];
+            record.cells.assign(tape.cells.data() + (loadedEnd[i] - tape.origin), static_cast<size_t>(end - loadedEnd[i]));
+            push(record);
+            loadedEnd[i] = end;
+        }
+    }
+}
+
+void VerboseWriter::Abort() {
+    if (!writer.joinable()) {
+        return;
+    }
+    Record record;
+    record.kind = RecordKind::ABORT;
+    pushWhenSpace(record);
+    writer.join();
+}
+
+// Rethrows the writer's error to stop the simulation.
+void VerboseWriter::push(Record& record) {
+    bool urgent = record.kind != RecordKind::STEP;
+    if (failed.load(std::memory_order_acquire) || !queue.TryPush(record)) {
+        TRACE_SPAN("queue full");
+        if (!pushWhenSpace(record)) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+    wake(writerWaiting, recordAvailable, urgent || queue.Size() % kWakeBatch == 0);
+}
+
+// Blocks until the record is queued; false if the writer failed instead.
+bool VerboseWriter::pushWhenSpace(Record& record) {
+    std::unique_lock<std::mutex> lock(mutex);
+    producerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool pushed = false;
+    while (!failed.load(std::memory_order_acquire) && !(pushed = queue.TryPush(record))) {
+        spaceAvailable.wait(lock);
+    }
+    producerWaiting.store(false, std::memory_order_relaxed);
+    lock.unlock();
+    if (pushed) {
+        wake(writerWaiting, recordAvailable, true);
+    }
+    return pushed;
+}
+
+// Blocks until the writer has taken every queued record, or has failed.
+void VerboseWriter::waitUntilDrained() {
+    std::unique_lock<std::mutex> lock(mutex);
+    producerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!failed.load(std::memory_order_acquire) && queue.Size() > 0) {
+        spaceAvailable.wait(lock);
+    }
+    producerWaiting.store(false, std::memory_order_relaxed);
+}
+
+void VerboseWriter::popWhenReady(Record& record) {
+    std::unique_lock<std::mutex> lock(mutex);
+    writerWaiting.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!queue.TryPop(record)) {
+        recordAvailable.wait(lock);
+    }
+    writerWaiting.store(false, std::memory_order_relaxed);
+}
+
+// The fence orders the queue update before the flag check.
+void VerboseWriter::wake(std::atomic<bool>& waiting, std::condition_variable& condition, bool due) {
+    if (!due) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        condition.notify_one();
+    }
+}
+
+void VerboseWriter::run() {
+    TRACE_THREAD_NAME("verbose writer");
+    try {
+        Record record;
+        while (true) {
+            if (!queue.TryPop(record)) {
+                TRACE_SPAN("queue empty");
+                popWhenReady(record);
+            }
+            size_t queued = queue.Size();
+            wake(producerWaiting, spaceAvailable, queued % kWakeBatch == 0 && queued <= queue.Capacity() / 2);
+            if (record.kind == RecordKind::STEP) {
+                ResultPrinter::PrintVerboseStep(record.step, replica, window);
+                MachineSimulator::applyTransition(replica, tm.transitions[static_cast<size_t>(record.transitionIndex)], tm.blankSymbol);
+            } else if (record.kind == RecordKind::LOAD) {
+                replica.tapes[record.tapeIndex].WriteRange(record.first, record.cells.data(), record.cells.size());
+            } else if (record.kind == RecordKind::SNAPSHOT) {
+                replica = std::move(record.snapshot);
+                record.snapshot = MachineConfiguration();
+            } else if (record.kind == RecordKind::HALT) {
+                ResultPrinter::PrintVerboseStep(record.step, replica, window);
+            } else if (record.kind == RecordKind::END) {
+                ResultPrinter::PrintVerboseResult(replica);
+                return;
+            } else {
+                ResultPrinter::FlushVerbose();
+                return;
+            }
+        }
+    } catch (...) {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(mutex);
+        spaceAvailable.notify_one();
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "SpscQueue.h"
+#include "StepObserver.h"
+#include "TracePredicate.h"
+#include "types/TuringMachine.h"
+#include "types/MachineConfiguration.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Renders the verbose trace on its own thread from a replica the run feeds
+// through a lock-free queue of fired transitions and snapshots.
+class VerboseWriter : public StepObserver {
+public:
+    VerboseWriter(const TuringMachine& tm, const MachineConfiguration& config, long long window, const TracePredicate* filter = nullptr);
+    ~VerboseWriter();
+
+    void BeforeStep(long long step, const MachineConfiguration& config, int transitionIndex);
+    void OnHalt(long long steps, MachineConfiguration& config);
+    // Ends the trace with the result line and waits for the writer. An
+    // error raised while writing is rethrown from the next record pushed.
+    void OnFinish(long long steps, const MachineConfiguration& config);
+    // Stops after writing what has been queued so far, without a result.
+    // Never throws, so it is safe to call while unwinding.
+    void Abort();
+
+private:
+    enum class RecordKind {
+        STEP,
+        LOAD,
+        SNAPSHOT,
+        HALT,
+        END,
+        ABORT
+    };
+
+    struct Record {
+        RecordKind kind = RecordKind::STEP;
+        int transitionIndex = 0;
+        long long step = 0;
+        size_t tapeIndex = 0;
+        long long first = 0;
+        std::string cells;
+        MachineConfiguration snapshot;
+    };
+
+    void catchUp(long long step, const MachineConfiguration& config, bool whole);
+    void sync(const MachineConfiguration& config);
+    void push(Record& record);
+    bool pushWhenSpace(Record& record);
+    void popWhenReady(Record& record);
+    void waitUntilDrained();
+    void wake(std::atomic<bool>& waiting, std::condition_variable& condition, bool due);
+    void run();
+
+    const TuringMachine& tm;
+    MachineConfiguration replica;
+    long long window;
+    const TracePredicate* filter;
+    std::vector<long long> loadedEnd;
+    // The step the replica will be at once the queued records are replayed,
+    // and whether it holds whole tapes rather than a windowed snapshot.
+    long long replicaStep = 0;
+    bool replicaWhole = true;
+    size_t snapshotBytes = 0;
+    SpscQueue<Record> queue;
+    std::mutex mutex;
+    std::condition_variable spaceAvailable;
+    std::condition_variable recordAvailable;
+    std::atomic<bool> producerWaiting{false};
+    std::atomic<bool> writerWaiting{false};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::thread writer;
+};
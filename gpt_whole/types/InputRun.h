@@ -0,0 +1,8 @@
+#pragma once
+#include <string>
+
+// One run of a run-length input specification: symbols repeated count times.
+struct InputRun {
+    std::string symbols;
+    long long count;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+enum class OutputFormat {
+    TEXT,
+    RLE,
+    BINARY
+};
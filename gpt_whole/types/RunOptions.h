@@ -0,0 +1,28 @@
+#pragma once
+#include "OutputFormat.h"
+#include "TraceMode.h"
+#include <string>
+
+struct RunOptions {
+    bool verbose = false;
+    OutputFormat outputFormat = OutputFormat::TEXT;
+    std::string dumpDirectory;
+    long long traceWindow = -1;
+    TraceMode traceMode = TraceMode::FULL;
+    long long keyframeInterval = -1;
+    std::string traceBinPath;
+    long long flightRecorder = -1;
+    std::string traceWhen;
+    long long traceEvery = 0;
+    long long progressIntervalMs = -1;
+    bool profile = false;
+    std::string profileJsonPath;
+    bool timings = false;
+    bool timingsJson = false;
+    std::string traceEventsPath;
+    bool sample = false;
+    std::string sampleFoldedPath;
+    long long sampleRate = 997;
+    bool tapeProfile = false;
+    bool assertNoAlloc = false;
+};
@@ -1,7 +1,81 @@
 #pragma once
-#include <map>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
 
+class InputStreamer;
+
+// cells[i] holds position origin + i; left/right bound the written cells
+// (left > right while empty).
 struct Tape {
-    std::map<int, char> cells;
-    int headPosition = 0;
+    std::vector<char> cells;
+    long long origin = 0;
+    long long left = 0;
+    long long right = -1;
+    long long headPosition = 0;
+    char blank = '_';
+    std::shared_ptr<InputStreamer> source;
+
+    bool Empty() const { return left > right; }
+
+    char Read(long long position) const {
+        long long offset = position - origin;
+        if (offset < 0 || offset >= static_cast<long long>(cells.size())) {
+            return blank;
+        }
+        return cells[static_cast<size_t>(offset)];
+    }
+
+    void Write(long long position, char symbol) {
+        Reserve(position, position);
+        cells[static_cast<size_t>(position - origin)] = symbol;
+        Touch(position, position);
+    }
+
+    void WriteRange(long long position, const char* symbols, size_t count) {
+        if (count == 0) return;
+        long long last = position + static_cast<long long>(count) - 1;
+        Reserve(position, last);
+        std::memcpy(&cells[static_cast<size_t>(position - origin)], symbols, count);
+        Touch(position, last);
+    }
+
+    void WriteRepeated(long long position, char symbol, size_t count) {
+        if (count == 0) return;
+        long long last = position + static_cast<long long>(count) - 1;
+        Reserve(position, last);
+        std::memset(&cells[static_cast<size_t>(position - origin)], symbol, count);
+        Touch(position, last);
+    }
+
+    // Grows the storage geometrically so that [first, last] is addressable.
+    void Reserve(long long first, long long last) {
+        long long size = static_cast<long long>(cells.size());
+        if (size == 0) {
+            origin = first;
+            cells.assign(static_cast<size_t>(last - first + 1), blank);
+            return;
+        }
+        if (last >= origin + size) {
+            long long grown = std::max(size * 2, last - origin + 1);
+            cells.resize(static_cast<size_t>(grown), blank);
+            size = grown;
+        }
+        if (first < origin) {
+            long long extra = std::max(size, origin - first);
+            cells.insert(cells.begin(), static_cast<size_t>(extra), blank);
+            origin -= extra;
+        }
+    }
+
+    void Touch(long long first, long long last) {
+        if (Empty()) {
+            left = first;
+            right = last;
+            return;
+        }
+        left = std::min(left, first);
+        right = std::max(right, last);
+    }
 };
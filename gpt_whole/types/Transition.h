@@ -9,4 +9,5 @@ struct Transition {
     std::vector<char> newSymbols;
     std::vector<Direction> directions;
     std::string newState;
+    int line = 0;  // 1-based line in the .tm file, 0 if unknown
 };